@@ -2,6 +2,7 @@
 #include <kitti_parser/Parser.h>
 #include <cxxopts.hpp>
 #include <ml/detect_ml_model.hpp>
+#include <ml/temporal_detector.hpp>
 
 #include <iostream>
 #include <filesystem>
@@ -53,6 +54,8 @@ struct Options {
     uint32_t wait;
     double speed;
     bool mask;
+    int tiles;
+    double reuseThreshold;
 };
 
 Options parseOpts(int argc, char **argv) {
@@ -67,6 +70,11 @@ Options parseOpts(int argc, char **argv) {
              cxxopts::value<uint32_t>()->default_value("1"))
             ("s,speed", "Speed multiplier", cxxopts::value<double>()->default_value("1.0"))
             ("mask", "Segmentation mask", cxxopts::value<bool>()->default_value("false"))
+            ("tiles", "Split frames into N overlapping tiles for inference - 0 == whole frame",
+             cxxopts::value<int>()->default_value("0"))
+            ("reuse-threshold", "Re-use detections of the previous frame when the frame changed less than this "
+                                "(mean abs difference, 0-255) - 0 == always infer",
+             cxxopts::value<double>()->default_value("0"))
             ("h,help", "Print usage");
     // clang-format on
 
@@ -84,8 +92,17 @@ Options parseOpts(int argc, char **argv) {
                 result["wait"].as<uint32_t>(),
                 result["speed"].as<double>(),
                 result["mask"].as<bool>(),
+                result["tiles"].as<int>(),
+                result["reuse-threshold"].as<double>(),
         };
 
+        // Temporal reuse propagates whole frame detections, it does not tile
+        if (opts.tiles > 0 && opts.reuseThreshold > 0) {
+            std::cerr << "Invalid options: --tiles and --reuse-threshold can not be combined" << std::endl;
+            std::cout << options.help().c_str() << std::endl;
+            exit(1);
+        }
+
         return opts;
     } catch (const cxxopts::exceptions::exception &e) {
         std::cerr << "Invalid options: " << e.what() << std::endl;
@@ -113,11 +130,21 @@ int main(int argc, char **argv) {
                                                                           "_drive_(" + options.index + ")_sync"));
     });
     ivd::ml::DetectMLModel model(options.model);
+    ivd::ml::TemporalDetector temporalDetector(model, {options.reuseThreshold});
 
     parser.register_callback_stereo_color([&](kitti_parser::Config *config, long ts, kitti_parser::stereo_t *frame) {
         std::cout << "Ts: " << ts << "\n\tImage left: " << frame->image_left_path << "\n\tImage Right: "
                   << frame->image_right_path << std::endl;
-        auto detections = model.predict(frame->image_left);
+        std::vector<ivd::ml::Detection> detections;
+        if (options.tiles > 0) {
+            detections = model.predictTiled(frame->image_left, {options.tiles});
+        } else if (options.reuseThreshold > 0) {
+            detections = temporalDetector.predict(frame->image_left);
+            auto &stats = temporalDetector.stats();
+            std::cout << "\tInferred: " << stats.inferred << ", skipped: " << stats.skipped << std::endl;
+        } else {
+            detections = model.predict(frame->image_left);
+        }
         std::cout << "\tDetections (" << detections.size() << "):" << std::endl;
         for (auto &detection: detections) {
             std::cout << "\t\t" << detection.className << ": " << detection.confidence << std::endl;
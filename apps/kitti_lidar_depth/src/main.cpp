@@ -1,9 +1,17 @@
 #include <kitti/kitti_utils.hpp>
 #include <common/opencv_utils.hpp>
 #include <common/projection.hpp>
+#include <fusion/fused_depth.hpp>
 #include <ml/detect_ml_model.hpp>
+#include <lidar/accumulator.hpp>
+#include <lidar/clustering.hpp>
+#include <lidar/deskew.hpp>
+#include <lidar/filters.hpp>
+#include <lidar/frustum.hpp>
 #include <lidar/lidar.hpp>
+#include <lidar/sparse_depth.hpp>
 #include <lidar/visualize.hpp>
+#include <stereo/depth_map.hpp>
 
 #include <kitti_parser/Parser.h>
 #include <cxxopts.hpp>
@@ -12,6 +20,7 @@
 #include <algorithm>
 #include <iostream>
 #include <filesystem>
+#include <optional>
 #include <regex>
 
 using namespace ivd;
@@ -70,6 +79,12 @@ struct Options {
     uint32_t wait;
     double speed;
     bool mask;
+    float voxelSize;
+    bool removeGround;
+    bool clusters;
+    bool fusion;
+    bool deskew;
+    uint32_t sweeps;
 };
 
 Options parseOpts(int argc, char **argv) {
@@ -84,6 +99,18 @@ Options parseOpts(int argc, char **argv) {
              cxxopts::value<uint32_t>()->default_value("1"))
             ("s,speed", "Speed multiplier", cxxopts::value<double>()->default_value("1.0"))
             ("mask", "Segmentation mask", cxxopts::value<bool>()->default_value("false"))
+            ("voxel", "Voxel size (m) to downsample the lidar points with - 0 == off",
+             cxxopts::value<float>()->default_value("0"))
+            ("remove-ground", "Remove lidar ground points", cxxopts::value<bool>()->default_value("false"))
+            ("clusters", "Distance from the lidar cluster matching a detection, falls back to the box median "
+                         "(implies --remove-ground)",
+             cxxopts::value<bool>()->default_value("false"))
+            ("fusion", "Distance from stereo restricted and completed by the lidar, inside the detections",
+             cxxopts::value<bool>()->default_value("false"))
+            ("deskew", "Motion compensate the lidar sweeps with the OXTS velocities",
+             cxxopts::value<bool>()->default_value("false"))
+            ("sweeps", "Number of lidar sweeps to accumulate, aligned with the OXTS velocities",
+             cxxopts::value<uint32_t>()->default_value("1"))
             ("h,help", "Print usage");
     // clang-format on
 
@@ -101,8 +128,23 @@ Options parseOpts(int argc, char **argv) {
                 result["wait"].as<uint32_t>(),
                 result["speed"].as<double>(),
                 result["mask"].as<bool>(),
+                result["voxel"].as<float>(),
+                result["remove-ground"].as<bool>(),
+                result["clusters"].as<bool>(),
+                result["fusion"].as<bool>(),
+                result["deskew"].as<bool>(),
+                result["sweeps"].as<uint32_t>(),
         };
 
+        // Without the ground all objects standing on it merge into one cluster
+        opts.removeGround = opts.removeGround || opts.clusters;
+
+        if (opts.sweeps == 0) {
+            std::cerr << "Invalid options: --sweeps must be at least 1" << std::endl;
+            std::cout << options.help().c_str() << std::endl;
+            exit(1);
+        }
+
         return opts;
     } catch (const cxxopts::exceptions::exception &e) {
         std::cerr << "Invalid options: " << e.what() << std::endl;
@@ -121,8 +163,10 @@ class Pipeline {
     const static constexpr char *lidarDepthWindow = "Lidar depth raw";
     const static constexpr float windowScale = 1.0; //0.7;
 public:
-    explicit Pipeline(const Options &options, cv::Mat velo_cam2) : options_(options), model_(options.model),
-                                                                   velo_cam2_(std::move(velo_cam2)) {
+    Pipeline(const Options &options, cv::Mat velo_cam2, cv::Mat imu_velo,
+             const stereo::DepthMapCalculator &stereoDepth)
+            : options_(options), model_(options.model), velo_cam2_(std::move(velo_cam2)),
+              imu_velo_(std::move(imu_velo)), sweeps_(options.sweeps), fused_(stereoDepth) {
         cv::namedWindow(leftWindowColor, cv::WINDOW_NORMAL);
         cv::namedWindow(rightWindowColor, cv::WINDOW_NORMAL);
         cv::namedWindow(lidarWindowColor, cv::WINDOW_NORMAL);
@@ -135,13 +179,13 @@ public:
     }
 
     void update(long ts, kitti_parser::stereo_t *frame) {
-        cv::Mat leftGray, rightGray;
-        cv::cvtColor(frame->image_left, leftGray, cv::ColorConversionCodes::COLOR_RGB2GRAY);
-        cv::cvtColor(frame->image_right, rightGray, cv::ColorConversionCodes::COLOR_RGB2GRAY);
+        cv::cvtColor(frame->image_left, leftGray_, cv::ColorConversionCodes::COLOR_RGB2GRAY);
+        cv::cvtColor(frame->image_right, rightGray_, cv::ColorConversionCodes::COLOR_RGB2GRAY);
 
         // cv::Mat is reference counted...
         leftColor_ = frame->image_left;
         rightColor_ = frame->image_right;
+        oxtsPath_ = kitti::oxtsPath(frame->image_left_path);
 
         // Get some detections
         // TODO: Use grayscale instead
@@ -151,11 +195,9 @@ public:
     }
 
     void update(long ts, kitti_parser::lidar_t *frame) {
-        // Initialize Mat with #points rows x 4 columns and strip the last column (no-copy)
-        cv::Mat data(frame->points.size(), 4, CV_32F, frame->points.data());
-        data = data.colRange(0, 3);
-
-        lidarDataFrameXYZW_ = lidar::makeHomogeneous(data);
+        // Keep the raw x, y, z, reflectance points until the frame is complete
+        auto *raw = reinterpret_cast<const float *>(frame->points.data());
+        lidarDataFrameXYZR_.assign(raw, raw + 4 * frame->points.size());
 
         update();
     }
@@ -163,26 +205,97 @@ public:
 private:
     void update() {
         // See if frame is complete
-        if (leftColor_.empty() || rightColor_.empty() || lidarDataFrameXYZW_.empty()) {
+        if (leftColor_.empty() || rightColor_.empty() || lidarDataFrameXYZR_.empty()) {
             return;
         }
 
-        veloUVZ_ = lidar::project(lidarDataFrameXYZW_, velo_cam2_, leftColor_.size());
-        depthMap_ = lidar::depthMapFromProjectedPoints(veloUVZ_, leftColor_.size());
-
-        auto distances = [](std::vector<ivd::ml::Detection> &detections, cv::Mat &depthMap, bool useMask) {
-            std::vector<double> distances;
-            distances.reserve(detections.size());
-            std::transform(detections.begin(), detections.end(), std::back_inserter(distances),
-                           [&](const ivd::ml::Detection &detection) {
-                               if (useMask) {
-                                   return ivd::lidar::getDepth(depthMap, detection.bbox, detection.mask).value_or(-1);
-                               } else {
-                                   return ivd::lidar::getDepth(depthMap, detection.bbox).value_or(-1);
-                               }
-                           });
-            return distances;
-        }(detections_, depthMap_, options_.mask);
+        std::optional<lidar::EgoMotion> motion;
+        if ((options_.deskew || options_.sweeps > 1) && std::filesystem::exists(oxtsPath_)) {
+            auto oxts = kitti::readOxts(oxtsPath_);
+            motion = lidar::EgoMotion::fromImu(oxts.velocity(), oxts.angularVelocity(), imu_velo_);
+        }
+
+        // Undo the ego motion during the sweep before anything uses the point positions
+        if (options_.deskew && motion) {
+            lidar::deskew(lidarDataFrameXYZR_.data(), lidarDataFrameXYZR_.size() / 4, *motion);
+        }
+
+        // Denser points from the previous sweeps, moved into the current velodyne frame
+        if (options_.sweeps > 1) {
+            if (motion) {
+                pose_ = pose_ * motion->transform(lidar::DeskewOptions{}.sweepDuration);
+            } else {
+                // Without the ego motion older sweeps can not be aligned
+                sweeps_.clear();
+            }
+            sweeps_.add(lidarDataFrameXYZR_.data(), lidarDataFrameXYZR_.size() / 4, pose_);
+            sweeps_.accumulate(filteredXYZR_);
+            lidarDataFrameXYZR_.swap(filteredXYZR_);
+        }
+
+        // Fewer, more relevant points
+        if (options_.voxelSize > 0) {
+            lidar::voxelDownsample(lidarDataFrameXYZR_.data(), lidarDataFrameXYZR_.size() / 4, options_.voxelSize,
+                                   filteredXYZR_);
+            lidarDataFrameXYZR_.swap(filteredXYZR_);
+        }
+        if (options_.removeGround) {
+            lidar::removeGround(lidarDataFrameXYZR_.data(), lidarDataFrameXYZR_.size() / 4, {}, filteredXYZR_);
+            lidarDataFrameXYZR_.swap(filteredXYZR_);
+        }
+
+        lidar::projectVelodyne(lidarDataFrameXYZR_.data(), lidarDataFrameXYZR_.size() / 4, velo_cam2_,
+                               leftColor_.size(), projected_);
+        veloUVZ_ = projected_.toMat();
+        sparseDepth_.assign(projected_, leftColor_.size(), lidar::SparseDepthMap::Keep::Nearest);
+
+        std::vector<cv::Rect> boxes;
+        std::vector<cv::Mat> masks;
+        for (auto &detection: detections_) {
+            boxes.push_back(detection.bbox);
+            masks.push_back(options_.mask ? detection.mask : cv::Mat());
+        }
+
+        // All detections in parallel
+        std::vector<double> distances;
+        distances.reserve(detections_.size());
+        for (auto &depth: sparseDepth_.getDepths(boxes, masks)) {
+            distances.push_back(depth.value_or(-1));
+        }
+
+        // Stereo searched in the disparity range the lidar gives per detection, holes filled from the lidar
+        if (options_.fusion) {
+            fused_.compute(leftGray_, rightGray_, sparseDepth_, boxes, fusedDepth_);
+            for (size_t i = 0; i < detections_.size(); i++) {
+                distances[i] = fusion::getDepth(fusedDepth_, boxes[i], masks[i]).value_or(distances[i]);
+            }
+            auto &stats = fused_.stats();
+            std::cout << "\tFused " << stats.regions << " detections, " << stats.seeded << " with lidar ranges ("
+                      << stats.rangeReduction() * 100 << "% fewer disparities), " << stats.rejected
+                      << " rejected" << std::endl;
+        }
+
+        // Object distance from the centroid of its cluster (depth in the camera frame)
+        if (options_.clusters) {
+            // Only points the camera sees can match a detection
+            lidar::FrustumCuller frustum(velo_cam2_, leftColor_.size());
+            inViewXYZR_.clear();
+            frustum.cull(lidarDataFrameXYZR_.data(), lidarDataFrameXYZR_.size() / 4, inViewXYZR_);
+
+            auto clusters = lidar::euclideanCluster(inViewXYZR_.data(), inViewXYZR_.size() / 4);
+            auto matches = lidar::associateClusters(inViewXYZR_.data(), clusters, boxes, velo_cam2_,
+                                                    leftColor_.size());
+            for (size_t i = 0; i < matches.size(); i++) {
+                if (matches[i] >= 0) {
+                    auto &c = clusters[matches[i]].centroid;
+                    cv::Mat uvw = velo_cam2_ * cv::Mat(cv::Vec4d(c.x, c.y, c.z, 1));
+                    distances[i] = uvw.at<double>(2);
+                }
+            }
+        }
+
+        // Dense depth map is only needed for visualization
+        depthMap_ = sparseDepth_.toDense();
 
         // Left color image
         annotateImage(leftColor_, detections_, distances, depthMap_, options_.mask);
@@ -200,7 +313,7 @@ private:
         // Draw lidar points
         std::cout << "Lidar point count:" << veloUVZ_.cols << std::endl;
         cv::Mat lidarMap(leftColor_.size(), CV_8UC3, cv::Scalar(0));
-        lidar::visualizeLidarPoints(lidarMap, veloUVZ_);
+        lidar::renderLidarPoints(lidarMap, projected_);
         cv::imshow(lidarWindowColor, lidarMap);
         cv::moveWindow(lidarWindowColor, 0, cv::getWindowImageRect(leftWindowColor).height * windowScale);
 
@@ -216,7 +329,7 @@ private:
         leftColor_ = cv::Mat();
         rightColor_ = cv::Mat();
         detections_.clear();
-        lidarDataFrameXYZW_ = cv::Mat();
+        lidarDataFrameXYZR_.clear();
         veloUVZ_ = cv::Mat();
         depthMap_ = cv::Mat();
     }
@@ -227,13 +340,27 @@ private:
 
     // Projection matrices
     cv::Mat velo_cam2_;
+    cv::Mat imu_velo_;
+
+    // Accumulated sweeps and the pose (velodyne -> first sweep) of the latest one
+    lidar::SweepAccumulator sweeps_;
+    cv::Matx44d pose_ = cv::Matx44d::eye();
 
     // Frame data
     cv::Mat leftColor_, rightColor_;
+    cv::Mat leftGray_, rightGray_;
+    std::filesystem::path oxtsPath_;
     std::vector<ml::Detection> detections_;
-    cv::Mat lidarDataFrameXYZW_;
+    std::vector<float> lidarDataFrameXYZR_;
+    std::vector<float> filteredXYZR_;
+    std::vector<float> inViewXYZR_;
+    lidar::ProjectedPoints projected_;
+    lidar::SparseDepthMap sparseDepth_;
     cv::Mat veloUVZ_;
     cv::Mat depthMap_;
+
+    fusion::FusedDepthEstimator fused_;
+    cv::Mat fusedDepth_;
 };
 
 int main(int argc, char **argv) {
@@ -290,7 +417,9 @@ int main(int argc, char **argv) {
     common::print<double>((cv::Mat) T_velo_cam2);
     assert(T_velo_cam2.size() == cv::Size(4, 3));
 
-    Pipeline pipeline(options, T_velo_cam2);
+    stereo::DepthMapCalculator stereoDepth(leftDecomp.cameraIntrinsic, leftDecomp.translation,
+                                           rightDecomp.translation);
+    Pipeline pipeline(options, T_velo_cam2, T_imu_velo, stereoDepth);
 
     parser.register_callback_stereo_color([&](kitti_parser::Config *config, long ts, kitti_parser::stereo_t *frame) {
         std::cout << "Ts: " << ts << "\n\tImage left: " << frame->image_left_path << "\n\tImage Right: "
@@ -1,9 +1,14 @@
 #include <kitti/kitti_utils.hpp>
 #include <common/opencv_utils.hpp>
 #include <common/projection.hpp>
+#include <stereo/confidence.hpp>
 #include <stereo/disparity.hpp>
+#include <stereo/parallel_disparity.hpp>
+#include <stereo/roi_disparity.hpp>
+#include <stereo/temporal_disparity.hpp>
 #include <stereo/depth_map.hpp>
 #include <ml/detect_ml_model.hpp>
+#include <ml/stereo_ml_model.hpp>
 
 #include <kitti_parser/Parser.h>
 #include <cxxopts.hpp>
@@ -11,6 +16,7 @@
 
 #include <iostream>
 #include <filesystem>
+#include <memory>
 #include <regex>
 
 void
@@ -78,6 +84,12 @@ struct Options {
     std::string index;
     uint32_t wait;
     double speed;
+    bool parallelSGBM;
+    bool roiSGBM;
+    bool temporalSGBM;
+    std::filesystem::path stereoModel;
+    bool mask;
+    bool lrCheck;
 };
 
 Options parseOpts(int argc, char **argv) {
@@ -91,6 +103,18 @@ Options parseOpts(int argc, char **argv) {
             ("w,wait", "Wait time (ms) between frames - 0 == wait indefinitely",
              cxxopts::value<uint32_t>()->default_value("1"))
             ("s,speed", "Speed multiplier", cxxopts::value<double>()->default_value("1.0"))
+            ("parallel-sgbm", "Strip parallel SGBM, one single threaded strip per thread "
+                              "(strips at least two blocks high)",
+             cxxopts::value<bool>()->default_value("false"))
+            ("roi-sgbm", "Only compute disparities for the detections",
+             cxxopts::value<bool>()->default_value("false"))
+            ("temporal-sgbm", "Restrict the disparity range per tile from the previous frame",
+             cxxopts::value<bool>()->default_value("false"))
+            ("stereo-model", "ONNX stereo model to use instead of SGBM",
+             cxxopts::value<std::string>()->default_value(""))
+            ("mask", "Segmentation mask", cxxopts::value<bool>()->default_value("false"))
+            ("lr-check", "Weight depths by their left-right consistency (matches the right image as well)",
+             cxxopts::value<bool>()->default_value("false"))
             ("h,help", "Print usage");
     // clang-format on
 
@@ -107,8 +131,32 @@ Options parseOpts(int argc, char **argv) {
                 result["index"].as<std::string>(),
                 result["wait"].as<uint32_t>(),
                 result["speed"].as<double>(),
+                result["parallel-sgbm"].as<bool>(),
+                result["roi-sgbm"].as<bool>(),
+                result["temporal-sgbm"].as<bool>(),
+                result["stereo-model"].as<std::string>(),
+                result["mask"].as<bool>(),
+                result["lr-check"].as<bool>(),
         };
 
+        // One disparity backend per run
+        auto modes = int(opts.parallelSGBM) + int(opts.roiSGBM) + int(opts.temporalSGBM) +
+                     int(!opts.stereoModel.empty());
+        if (modes > 1) {
+            std::cerr << "Invalid options: --parallel-sgbm, --roi-sgbm, --temporal-sgbm and --stereo-model can not be "
+                         "combined" << std::endl;
+            std::cout << options.help().c_str() << std::endl;
+            exit(1);
+        }
+
+        // The right view is matched with full frame SGBM, only consistent with a full frame SGBM left view
+        if (opts.lrCheck && (opts.roiSGBM || opts.temporalSGBM || !opts.stereoModel.empty())) {
+            std::cerr << "Invalid options: --lr-check can not be combined with --roi-sgbm, --temporal-sgbm or "
+                         "--stereo-model" << std::endl;
+            std::cout << options.help().c_str() << std::endl;
+            exit(1);
+        }
+
         return opts;
     } catch (const cxxopts::exceptions::exception &e) {
         std::cerr << "Invalid options: " << e.what() << std::endl;
@@ -147,12 +195,28 @@ int main(int argc, char **argv) {
     });
 
     ivd::ml::DetectMLModel model(options.model);
+    // The left-right check weights depths by consistency, uniqueness drops the ambiguous matches before
+    ivd::stereo::SGBMParameters sgbmParameters;
+    if (options.lrCheck) {
+        sgbmParameters.uniquenessRatio = 10;
+    }
+    ivd::stereo::DisparityEstimator disparityEstimator(sgbmParameters);
+    ivd::stereo::StripDisparityEstimator stripDisparityEstimator(sgbmParameters);
+    ivd::stereo::RoiDisparityEstimator roiDisparityEstimator;
+    ivd::stereo::TemporalDisparityEstimator temporalDisparityEstimator;
+    std::unique_ptr<ivd::ml::StereoMLModel> stereoModel;
+    if (!options.stereoModel.empty()) {
+        stereoModel = std::make_unique<ivd::ml::StereoMLModel>(options.stereoModel);
+    }
 
     auto camCalibration = parser.getConfig().calib_cc;
     auto pRect02 = ivd::kitti::parseMatrix(camCalibration["P_rect_02"], 3, 4);
     auto pRect03 = ivd::kitti::parseMatrix(camCalibration["P_rect_03"], 3, 4);
     auto leftDecomp = ivd::common::decomposeProjectionMatrix(pRect02);
     auto rightDecomp = ivd::common::decomposeProjectionMatrix(pRect03);
+    ivd::stereo::DepthMapCalculator depthMapCalculator(leftDecomp.cameraIntrinsic, leftDecomp.translation,
+                                                       rightDecomp.translation);
+    cv::Mat depthMap, rightDisparity, confidence;
 
 
     // Calculate projection to euclidian space from IMU point of reference
@@ -196,24 +260,46 @@ int main(int argc, char **argv) {
 
         // Get some detections
         auto detections = model.predict(frame->image_left);
+        std::vector<cv::Rect> boxes;
+        std::vector<cv::Mat> masks;
+        for (auto &detection: detections) {
+            boxes.push_back(detection.bbox);
+            masks.push_back(options.mask ? detection.mask : cv::Mat());
+        }
 
         // Calculate disparity map
-        auto disparity = ivd::stereo::disparityMapSGBM(leftGray, rightGray);
+        cv::Mat disparity;
+        if (stereoModel) {
+            disparity = stereoModel->predict(frame->image_left, frame->image_right);
+        } else if (options.roiSGBM) {
+            disparity = roiDisparityEstimator.compute(leftGray, rightGray, boxes);
+        } else if (options.temporalSGBM) {
+            disparity = temporalDisparityEstimator.compute(leftGray, rightGray);
+            auto &stats = temporalDisparityEstimator.stats();
+            std::cout << "\tDisparity range reduced by " << stats.rangeReduction() * 100 << "%, runtime by "
+                      << stats.timeSaved() * 100 << "%" << std::endl;
+        } else if (options.parallelSGBM) {
+            disparity = stripDisparityEstimator.compute(leftGray, rightGray);
+        } else {
+            disparity = disparityEstimator.compute(leftGray, rightGray);
+        }
+        // Both views unfiltered, before the blur
+        if (options.lrCheck) {
+            disparityEstimator.computeRight(leftGray, rightGray, rightDisparity);
+            ivd::stereo::leftRightConfidence(disparity, rightDisparity, confidence);
+        }
         cv::medianBlur(disparity, disparity, 5);
-        auto depthMap = ivd::stereo::calculateDepthMap(disparity, leftDecomp.cameraIntrinsic, leftDecomp.translation,
-                                                       rightDecomp.translation);
-        auto distances = [](std::vector<ivd::ml::Detection> &detections, cv::Mat &depthMap) {
-            std::vector<double> distances;
-            distances.reserve(detections.size());
-            std::transform(detections.begin(), detections.end(), std::back_inserter(distances),
-                           [&depthMap](const ivd::ml::Detection &detection) {
-                               return ivd::stereo::getDepth(depthMap, detection.bbox);
-                           });
-            return distances;
-        }(detections, depthMap);
+        depthMapCalculator.compute(disparity, depthMap);
+
+        // All detections in parallel
+        std::vector<double> distances;
+        distances.reserve(detections.size());
+        for (auto &depth: ivd::stereo::getDepths(depthMap, boxes, masks, confidence)) {
+            distances.push_back(depth.value_or(-1));
+        }
 
         // Annotate image
-        annotateImage(frame->image_left, detections, distances, false);
+        annotateImage(frame->image_left, detections, distances, options.mask);
 
         // Left color image
         cv::imshow(leftWindowColor, frame->image_left);
@@ -237,11 +323,16 @@ int main(int argc, char **argv) {
         cv::moveWindow(disparityMapWindow, 0, cv::getWindowImageRect(leftWindowColor).height);
 
         // Dept map window
-        // Log and normalize for reasonable visualization
-        cv::log(depthMap, depthMap);
-        cv::normalize(depthMap, depthMap, 0, 255, cv::NORM_MINMAX, CV_8UC1);
-        cv::applyColorMap(depthMap, depthMap, cv::ColormapTypes::COLORMAP_VIRIDIS);
-        cv::imshow(depthMapWindow, depthMap);
+        // Log and normalize for reasonable visualization, pixels without depth show as the farthest
+        cv::Mat valid = depthMap > 0;
+        cv::Mat logDepth;
+        cv::log(depthMap, logDepth);
+        double maxLogDepth = 0;
+        cv::minMaxLoc(logDepth, nullptr, &maxLogDepth, nullptr, nullptr, valid);
+        logDepth.setTo(maxLogDepth, ~valid);
+        cv::normalize(logDepth, logDepth, 0, 255, cv::NORM_MINMAX, CV_8UC1);
+        cv::applyColorMap(logDepth, logDepth, cv::ColormapTypes::COLORMAP_VIRIDIS);
+        cv::imshow(depthMapWindow, logDepth);
         cv::moveWindow(depthMapWindow, cv::getWindowImageRect(leftWindowColor).width,
                        cv::getWindowImageRect(disparityMapWindow).height);
 
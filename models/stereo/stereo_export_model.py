@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+import torch
+from torchvision.models.optical_flow import Raft_Small_Weights, raft_small
+
+
+class RaftStereo(torch.nn.Module):
+    """
+    Small pretrained RAFT as a stereo matcher: on a rectified pair the flow from left to right is horizontal,
+    the disparity is its negated x component. Takes the left and right images (NCHW, RGB, 0..1) as two inputs,
+    returns the disparity [1, 1, H, W] in pixels (see modules/ml/include/ml/stereo_ml_model.hpp).
+    """
+
+    def __init__(self):
+        super().__init__()
+        self.raft = raft_small(weights=Raft_Small_Weights.DEFAULT).eval()
+
+    def forward(self, left, right):
+        # RAFT expects -1..1
+        flows = self.raft(left * 2 - 1, right * 2 - 1, num_flow_updates=12)
+        return -flows[-1][:, :1]
+
+
+model = RaftStereo()
+
+# KITTI frames (1242x375) rounded down to a multiple of 32
+left = torch.rand(1, 3, 352, 1216)
+right = torch.rand(1, 3, 352, 1216)
+
+with torch.no_grad():
+    torch.onnx.export(model, (left, right), 'stereo.onnx', opset_version=16,
+                      input_names=['left', 'right'], output_names=['disparity'])
@@ -1,7 +1,15 @@
 #!/usr/bin/env python3
+import os
+
 from ultralytics import YOLO
 
 for file in ['yolov8n.pt', 'yolov8n-seg.pt']:
     model = YOLO(file)
     model.export(format='coreml', nms=True)
+
+    # Rectangular input matching the aspect ratio of KITTI / comma frames (less letterbox padding).
+    # Exported first, it is written to the same path as the square model and renamed out of the way.
+    path = model.export(format='onnx', imgsz=[192, 640])
+    os.replace(path, path.replace('.onnx', '-640x192.onnx'))
+
     model.export(format='onnx')
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <cassert>
+#include <cstdint>
+
+namespace ivd::common {
+
+    /**
+     * Depth maps (m, 0 == no depth) come as CV_64F (lidar) or CV_32F (stereo). They are mostly empty or
+     * quantized anyway, so two compact formats at a quarter / half of the memory traffic are supported as well:
+     * - CV_16U: depth * depthScale16U (KITTI depth benchmark convention), 3.9mm steps up to 256m, beyond saturates
+     * - CV_16F: half precision, 11 significant bits (3cm steps at 50m)
+     */
+    constexpr double depthScale16U = 256;
+
+    // Meters per unit of a depth map of type
+    inline double depthUnit(int type) {
+        assert(type == CV_64F || type == CV_32F || type == CV_16F || type == CV_16U);
+        return type == CV_16U ? 1 / depthScale16U : 1;
+    }
+
+    // Depth map in another format (see depthUnit), in parallel row bands. Negative depths become 0 in CV_16U
+    void convertDepth(const cv::Mat &depth, cv::Mat &out, int type);
+
+    cv::Mat convertDepth(const cv::Mat &depth, int type);
+
+    /**
+     * Calls fn(T()) with the element type of a depth map of type (double, float, cv::float16_t or uint16_t),
+     * for queries working on any format. Values times depthUnit(type) are meters.
+     */
+    template<class Fn>
+    decltype(auto) dispatchDepth(int type, Fn &&fn) {
+        switch (type) {
+            case CV_64F:
+                return fn(double());
+            case CV_32F:
+                return fn(float());
+            case CV_16F:
+                return fn(cv::float16_t());
+            default:
+                assert(type == CV_16U);
+                return fn(uint16_t());
+        }
+    }
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <common/quantile.hpp>
+
 #include <opencv2/opencv.hpp>
 
 #include <iostream>
@@ -9,30 +11,21 @@ namespace ivd::common {
 
     template<class T>
     double median(const cv::Mat &in) {
-        assert(in.elemSize() == sizeof(T));
-        std::vector<T> tmp;
-        tmp.reserve(in.total());
-        for (int i = 0; i < in.rows; ++i) {
-            tmp.insert(tmp.end(), in.ptr<T>(i), in.ptr<T>(i) + in.cols * in.channels());
-        }
-        std::nth_element(tmp.begin(), tmp.begin() + tmp.size() / 2, tmp.end());
-        return tmp[tmp.size() / 2];
+        auto &tmp = quantileScratch<T>();
+        gather(in, cv::Mat(), [](auto &) { return true; }, tmp);
+        return quantile(tmp, 0.5);
     }
 
     template<class T, class Fn>
     std::optional<double> median(const cv::Mat &in, Fn &&filter) {
-        assert(in.elemSize() == sizeof(T));
-        std::vector<T> tmp;
-        std::copy_if(in.begin<T>(), in.end<T>(), std::back_inserter(tmp), filter);
-
-        if (tmp.empty()) {
-            return {};
-        }
-
-        std::nth_element(tmp.begin(), tmp.begin() + tmp.size() / 2, tmp.end());
-        return tmp[tmp.size() / 2];
+        return quantile<T>(in, cv::Mat(), 0.5, filter);
     }
 
+    // Only pixels where mask (CV_8U, size of in) is set count
+    template<class T, class Fn>
+    std::optional<double> median(const cv::Mat &in, const cv::Mat &mask, Fn &&filter) {
+        return quantile<T>(in, mask, 0.5, filter);
+    }
 
     template<class T>
     cv::Mat createMat(cv::Size size, std::initializer_list<T> values, int channels = 1) {
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <optional>
+#include <vector>
+
+namespace ivd::common {
+
+    /**
+     * Per thread scratch buffer for quantile queries, cleared on every call. Reused across calls so queries
+     * do not allocate once the buffer has grown to the largest query. Only valid until the next call on the
+     * same thread.
+     */
+    template<class T>
+    std::vector<T> &quantileScratch() {
+        thread_local std::vector<T> scratch;
+        scratch.clear();
+        return scratch;
+    }
+
+    /**
+     * Runs query(i) for every i < count in parallel and collects the results in order, eg the depths of all
+     * detections of a frame. Queries on the quantile scratch share one buffer per worker thread.
+     */
+    template<class Fn>
+    auto parallelQueries(size_t count, Fn &&query) {
+        std::vector<decltype(query(size_t()))> results(count);
+        cv::parallel_for_(cv::Range(0, int(count)), [&](const cv::Range &range) {
+            for (int i = range.start; i < range.end; i++) {
+                results[i] = query(size_t(i));
+            }
+        });
+        return results;
+    }
+
+    /**
+     * Appends the values of in (single channel) passing filter to out. When given, only pixels where mask
+     * (CV_8U, size of in) is set count.
+     */
+    template<class T, class Fn>
+    void gather(const cv::Mat &in, const cv::Mat &mask, Fn &&filter, std::vector<T> &out) {
+        assert(in.elemSize() == sizeof(T));
+        assert(mask.empty() || (mask.type() == CV_8U && mask.size() == in.size()));
+
+        for (int row = 0; row < in.rows; row++) {
+            auto *values = in.ptr<T>(row);
+            if (mask.empty()) {
+                for (int col = 0; col < in.cols; col++) {
+                    if (filter(values[col])) {
+                        out.push_back(values[col]);
+                    }
+                }
+            } else {
+                auto *m = mask.ptr<uchar>(row);
+                for (int col = 0; col < in.cols; col++) {
+                    if (m[col] && filter(values[col])) {
+                        out.push_back(values[col]);
+                    }
+                }
+            }
+        }
+    }
+
+    // Index of quantile q in n sorted values, q == 0.5 gives the upper median
+    inline size_t quantileIndex(double q, size_t n) {
+        assert(q >= 0 && q <= 1);
+        assert(n > 0);
+        return std::min(size_t(q * double(n)), n - 1);
+    }
+
+    // Quantile q of values (non-empty), partially reorders them
+    template<class T>
+    double quantile(std::vector<T> &values, double q) {
+        auto nth = values.begin() + quantileIndex(q, values.size());
+        std::nth_element(values.begin(), nth, values.end());
+        return *nth;
+    }
+
+    /**
+     * Several quantiles of values (non-empty) at once, partially reorders them. Every selection only
+     * searches the part right of the previous one, so p10/p50/p90 cost about as much as a single median.
+     */
+    template<class T, size_t N>
+    std::array<double, N> quantiles(std::vector<T> &values, const std::array<double, N> &q) {
+        std::array<size_t, N> order;
+        for (size_t i = 0; i < N; i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](auto a, auto b) { return q[a] < q[b]; });
+
+        std::array<double, N> result;
+        auto first = values.begin();
+        for (auto i: order) {
+            auto nth = values.begin() + quantileIndex(q[i], values.size());
+            std::nth_element(first, nth, values.end());
+            first = nth;
+            result[i] = *nth;
+        }
+        return result;
+    }
+
+    /**
+     * Approximate quantiles from a histogram over [min, max), O(n) and without gathering the values.
+     * Values outside of the range are counted in the first or last bin. The error is below
+     * (max - min) / bins.
+     */
+    struct HistogramQuantiles {
+        double min{0};
+        double max{100};
+        int bins{1024};
+    };
+
+    // Exact quantiles gather and select, boxes with at least histogramAbove pixels use the histogram instead
+    struct QuantileOptions {
+        // 0 == always exact
+        size_t histogramAbove{0};
+        HistogramQuantiles histogram{};
+    };
+
+    template<class T, size_t N, class Fn>
+    std::optional<std::array<double, N>> histogramQuantiles(const cv::Mat &in, const cv::Mat &mask,
+                                                           const std::array<double, N> &q, Fn &&filter,
+                                                           const HistogramQuantiles &options) {
+        assert(in.elemSize() == sizeof(T));
+        assert(mask.empty() || (mask.type() == CV_8U && mask.size() == in.size()));
+        assert(options.bins > 0 && options.max > options.min);
+
+        auto &counts = quantileScratch<uint32_t>();
+        counts.resize(options.bins, 0);
+        const double scale = options.bins / (options.max - options.min);
+        const int lastBin = options.bins - 1;
+
+        size_t n = 0;
+        for (int row = 0; row < in.rows; row++) {
+            auto *values = in.ptr<T>(row);
+            auto *m = mask.empty() ? nullptr : mask.ptr<uchar>(row);
+            for (int col = 0; col < in.cols; col++) {
+                if ((!m || m[col]) && filter(values[col])) {
+                    auto bin = int((double(values[col]) - options.min) * scale);
+                    counts[std::clamp(bin, 0, lastBin)]++;
+                    n++;
+                }
+            }
+        }
+
+        if (n == 0) {
+            return {};
+        }
+
+        // Walk the cumulative counts, interpolate within the bin
+        std::array<double, N> result;
+        const double width = 1 / scale;
+        for (size_t i = 0; i < N; i++) {
+            auto k = quantileIndex(q[i], n);
+            size_t cumulative = 0;
+            int bin = 0;
+            while (cumulative + counts[bin] <= k) {
+                cumulative += counts[bin++];
+            }
+            result[i] = options.min + width * (bin + (double(k - cumulative) + 0.5) / counts[bin]);
+        }
+        return result;
+    }
+
+    /**
+     * Weighted quantiles from a histogram in a single pass over in, without gathering the values. Every value
+     * passing filter (and mask when given) adds its weight (weights CV_32F, size of in, empty == 1) to its bin,
+     * values with a weight <= 0 do not count. Same range and error as histogramQuantiles.
+     */
+    template<class T, size_t N, class Fn>
+    std::optional<std::array<double, N>> weightedQuantiles(const cv::Mat &in, const cv::Mat &mask,
+                                                          const cv::Mat &weights, const std::array<double, N> &q,
+                                                          Fn &&filter, const HistogramQuantiles &options = {}) {
+        assert(in.elemSize() == sizeof(T));
+        assert(mask.empty() || (mask.type() == CV_8U && mask.size() == in.size()));
+        assert(weights.empty() || (weights.type() == CV_32F && weights.size() == in.size()));
+        assert(options.bins > 0 && options.max > options.min);
+
+        auto &bins = quantileScratch<double>();
+        bins.resize(options.bins, 0);
+        const double scale = options.bins / (options.max - options.min);
+        const int lastBin = options.bins - 1;
+
+        double total = 0;
+        for (int row = 0; row < in.rows; row++) {
+            auto *values = in.ptr<T>(row);
+            auto *m = mask.empty() ? nullptr : mask.ptr<uchar>(row);
+            auto *w = weights.empty() ? nullptr : weights.ptr<float>(row);
+            for (int col = 0; col < in.cols; col++) {
+                double weight = w ? w[col] : 1;
+                if (weight > 0 && (!m || m[col]) && filter(values[col])) {
+                    auto bin = int((double(values[col]) - options.min) * scale);
+                    bins[std::clamp(bin, 0, lastBin)] += weight;
+                    total += weight;
+                }
+            }
+        }
+
+        if (total <= 0) {
+            return {};
+        }
+
+        // Walk the cumulative weights to the first bin reaching q * total, interpolate within it. The walk ends
+        // at the last non-empty bin, which q == 1 (or rounding) would otherwise walk past
+        int lastUsed = lastBin;
+        while (bins[lastUsed] <= 0) {
+            lastUsed--;
+        }
+        std::array<double, N> result;
+        const double width = 1 / scale;
+        for (size_t i = 0; i < N; i++) {
+            assert(q[i] >= 0 && q[i] <= 1);
+            auto target = q[i] * total;
+            double cumulative = 0;
+            int bin = 0;
+            while (bin < lastUsed && (bins[bin] <= 0 || cumulative + bins[bin] <= target)) {
+                cumulative += bins[bin++];
+            }
+            auto fraction = std::clamp((target - cumulative) / bins[bin], 0.0, 1.0);
+            result[i] = options.min + width * (bin + fraction);
+        }
+        return result;
+    }
+
+    /**
+     * Quantiles of the values of in passing filter (and mask when given), without copying in. Uses the
+     * per thread scratch, so it does not allocate in steady state.
+     */
+    template<class T, size_t N, class Fn>
+    std::optional<std::array<double, N>> quantiles(const cv::Mat &in, const cv::Mat &mask,
+                                                  const std::array<double, N> &q, Fn &&filter,
+                                                  const QuantileOptions &options = {}) {
+        if (options.histogramAbove > 0 && in.total() >= options.histogramAbove) {
+            return histogramQuantiles<T>(in, mask, q, filter, options.histogram);
+        }
+
+        auto &values = quantileScratch<T>();
+        gather(in, mask, filter, values);
+        if (values.empty()) {
+            return {};
+        }
+        return quantiles(values, q);
+    }
+
+    template<class T, class Fn>
+    std::optional<double> quantile(const cv::Mat &in, const cv::Mat &mask, double q, Fn &&filter,
+                                   const QuantileOptions &options = {}) {
+        auto result = quantiles<T>(in, mask, std::array<double, 1>{q}, filter, options);
+        if (!result) {
+            return {};
+        }
+        return (*result)[0];
+    }
+}
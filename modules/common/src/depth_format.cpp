@@ -0,0 +1,23 @@
+#include <common/depth_format.hpp>
+
+namespace ivd::common {
+
+    void convertDepth(const cv::Mat &depth, cv::Mat &out, int type) {
+        assert(depth.channels() == 1);
+        assert(&depth != &out);
+
+        const double scale = depthUnit(depth.type()) / depthUnit(type);
+        out.create(depth.size(), type);
+        cv::parallel_for_(cv::Range(0, depth.rows), [&](const cv::Range &range) {
+            // Same size and type, converts in place
+            cv::Mat band = out.rowRange(range.start, range.end);
+            depth.rowRange(range.start, range.end).convertTo(band, type, scale);
+        }, double(depth.total()) / 65536);
+    }
+
+    cv::Mat convertDepth(const cv::Mat &depth, int type) {
+        cv::Mat out;
+        convertDepth(depth, out, type);
+        return out;
+    }
+}
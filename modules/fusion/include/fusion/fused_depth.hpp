@@ -0,0 +1,90 @@
+#pragma once
+
+#include <lidar/sparse_depth.hpp>
+#include <stereo/depth_map.hpp>
+#include <stereo/disparity.hpp>
+#include <stereo/roi_disparity.hpp>
+
+#include <opencv2/opencv.hpp>
+
+#include <optional>
+#include <vector>
+
+namespace ivd::fusion {
+
+    struct FusionOptions {
+        // Quantiles of the lidar depths in a box that bound its disparity range
+        double low{0.05};
+        double high{0.95};
+        // Added around the lidar range (px), covers calibration error and the lidar/camera offset
+        int margin{8};
+        // Boxes with fewer lidar pixels are searched over the full range and not validated
+        size_t minPoints{5};
+        // Stereo depth within this relative error of the lidar depth at the same pixel agrees with it
+        double maxRelativeError{0.1};
+        // Regions where a smaller fraction of the compared pixels agrees drop their stereo depth
+        double minAgreement{0.5};
+        // Fill pixels without a stereo depth with the median lidar depth of their region
+        bool fillHoles{true};
+    };
+
+    /**
+     * Dense depth for boxes (eg detections) from stereo constrained by lidar. The lidar depths inside a box
+     * bound its disparity search (d = f * b / z), the stereo result is checked against the lidar pixels it
+     * overlaps, and lidar depth replaces stereo where both exist. Boxes are processed in order, later ones win
+     * where they overlap.
+     */
+    class FusedDepthEstimator {
+    public:
+        struct Stats {
+            size_t regions{0};
+            // Regions with a range from the lidar
+            size_t seeded{0};
+            // Regions where stereo disagreed with the lidar
+            size_t rejected{0};
+            // Pixels filled from the lidar
+            size_t filled{0};
+            // Disparities searched (pixels * range), relative to the full range
+            double searched{0};
+            double full{0};
+
+            double rangeReduction() const {
+                return full > 0 ? 1 - searched / full : 0;
+            }
+        };
+
+        explicit FusedDepthEstimator(const stereo::DepthMapCalculator &calculator,
+                                     const stereo::SGBMParameters &parameters = {},
+                                     const FusionOptions &options = {});
+
+        // Disparity regions for boxes, with ranges from the lidar depths inside them
+        std::vector<stereo::DisparityRegion> regions(const lidar::SparseDepthMap &lidarDepth,
+                                                     const std::vector<cv::Rect> &boxes);
+
+        // Depth (CV_32F, m) inside the boxes, 0 elsewhere and where neither sensor has a depth
+        void compute(const cv::Mat &left, const cv::Mat &right, const lidar::SparseDepthMap &lidarDepth,
+                     const std::vector<cv::Rect> &boxes, cv::Mat &depth);
+
+        cv::Mat compute(const cv::Mat &left, const cv::Mat &right, const lidar::SparseDepthMap &lidarDepth,
+                        const std::vector<cv::Rect> &boxes);
+
+        // Of the last compute
+        const Stats &stats() const {
+            return stats_;
+        }
+
+    private:
+        stereo::DepthMapCalculator calculator_;
+        stereo::SGBMParameters parameters_;
+        FusionOptions options_;
+        stereo::RoiDisparityEstimator stereo_;
+        Stats stats_;
+
+        // Frame scratch
+        cv::Mat disparity_;
+        std::vector<double> lidarMedians_;
+    };
+
+    // Median of the depths (> 0) in bbox, only where mask (CV_8U, size of bbox) is set when given
+    std::optional<double> getDepth(const cv::Mat &depth, const cv::Rect &bbox, const cv::Mat &mask = {});
+}
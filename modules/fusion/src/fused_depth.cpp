@@ -0,0 +1,104 @@
+#include <fusion/fused_depth.hpp>
+
+#include <common/opencv_utils.hpp>
+#include <common/quantile.hpp>
+
+#include <cmath>
+
+namespace ivd::fusion {
+
+    FusedDepthEstimator::FusedDepthEstimator(const stereo::DepthMapCalculator &calculator,
+                                             const stereo::SGBMParameters &parameters, const FusionOptions &options)
+            : calculator_(calculator), parameters_(parameters), options_(options), stereo_(parameters, {0}) {
+        assert(options.low >= 0 && options.low <= options.high && options.high <= 1);
+    }
+
+    std::vector<stereo::DisparityRegion> FusedDepthEstimator::regions(const lidar::SparseDepthMap &lidarDepth,
+                                                                      const std::vector<cv::Rect> &boxes) {
+        stats_ = {};
+        lidarMedians_.assign(boxes.size(), 0);
+
+        const cv::Rect image({}, lidarDepth.size());
+        const double fb = calculator_.focalLength() * calculator_.baseline();
+
+        std::vector<stereo::DisparityRegion> result;
+        for (size_t i = 0; i < boxes.size(); i++) {
+            stereo::DisparityRegion region{boxes[i] & image, parameters_.minDisparity, parameters_.numDisparities};
+
+            auto &depths = common::quantileScratch<float>();
+            lidarDepth.forEach(region.rect, [&](int, int, float z) { depths.push_back(z); });
+            if (depths.size() >= options_.minPoints) {
+                auto q = common::quantiles(depths, std::array<double, 3>{options_.low, 0.5, options_.high});
+                lidarMedians_[i] = q[1];
+
+                // Far bounds the low disparity, near the high one
+                auto seeded = stereo::rangeRegion(region.rect, fb / q[2] - options_.margin,
+                                                  fb / q[0] + options_.margin, parameters_);
+                if (seeded) {
+                    region = *seeded;
+                    stats_.seeded++;
+                }
+            }
+
+            stats_.regions++;
+            stats_.searched += double(region.rect.area()) * region.numDisparities;
+            stats_.full += double(region.rect.area()) * parameters_.numDisparities;
+            result.push_back(region);
+        }
+        return result;
+    }
+
+    void FusedDepthEstimator::compute(const cv::Mat &left, const cv::Mat &right,
+                                      const lidar::SparseDepthMap &lidarDepth, const std::vector<cv::Rect> &boxes,
+                                      cv::Mat &depth) {
+        assert(left.size() == lidarDepth.size());
+
+        auto regions = this->regions(lidarDepth, boxes);
+        stereo_.compute(left, right, regions, disparity_);
+        calculator_.compute(disparity_, depth);
+
+        for (size_t i = 0; i < regions.size(); i++) {
+            auto &region = regions[i];
+            if (region.rect.empty() || lidarMedians_[i] <= 0) {
+                continue; // Stereo only
+            }
+            cv::Mat regionDepth = depth(region.rect);
+
+            // Validate against the lidar pixels the stereo depth overlaps
+            size_t compared = 0;
+            size_t agreed = 0;
+            lidarDepth.forEach(region.rect, [&](int col, int row, float z) {
+                auto s = depth.at<float>(row, col);
+                if (s > 0) {
+                    compared++;
+                    agreed += std::abs(s - z) <= options_.maxRelativeError * z;
+                }
+            });
+            if (compared >= options_.minPoints && double(agreed) < options_.minAgreement * double(compared)) {
+                regionDepth.setTo(0);
+                stats_.rejected++;
+            }
+
+            // Lidar wins where both exist
+            lidarDepth.forEach(region.rect, [&](int col, int row, float z) { depth.at<float>(row, col) = z; });
+
+            if (options_.fillHoles) {
+                cv::Mat holes = regionDepth == 0;
+                stats_.filled += cv::countNonZero(holes);
+                regionDepth.setTo(lidarMedians_[i], holes);
+            }
+        }
+    }
+
+    cv::Mat FusedDepthEstimator::compute(const cv::Mat &left, const cv::Mat &right,
+                                         const lidar::SparseDepthMap &lidarDepth, const std::vector<cv::Rect> &boxes) {
+        cv::Mat depth;
+        compute(left, right, lidarDepth, boxes, depth);
+        return depth;
+    }
+
+    std::optional<double> getDepth(const cv::Mat &depth, const cv::Rect &bbox, const cv::Mat &mask) {
+        assert(depth.type() == CV_32F);
+        return common::median<float>(depth(bbox), mask, [](float z) { return z > 0; });
+    }
+}
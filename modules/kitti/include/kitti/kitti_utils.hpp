@@ -3,10 +3,31 @@
 #include <opencv2/opencv.hpp>
 #include <yaml-cpp/yaml.h>
 
+#include <array>
 #include <filesystem>
 
 namespace ivd::kitti {
     cv::Mat parseMatrix(const YAML::Node &input, int rows, int cols);
 
     std::vector<std::array<float, 4>> readVeloBin(const std::filesystem::path &file);
+
+    // One GPS/IMU record of a raw drive (oxts/data/<frame>.txt), see the KITTI raw data devkit for the fields
+    struct Oxts {
+        std::array<double, 30> values{};
+
+        // vf, vl, vu: forward, leftward, upward velocity (m/s) in the IMU frame
+        cv::Vec3d velocity() const {
+            return {values[8], values[9], values[10]};
+        }
+
+        // wf, wl, wu: angular rate (rad/s) around the forward, leftward, upward axes
+        cv::Vec3d angularVelocity() const {
+            return {values[20], values[21], values[22]};
+        }
+    };
+
+    Oxts readOxts(const std::filesystem::path &file);
+
+    // OXTS record of the frame of a synced drive image (<drive>/image_xx/data/<frame>.png)
+    std::filesystem::path oxtsPath(const std::filesystem::path &imagePath);
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include <kitti/kitti_utils.hpp>
 
+#include <fstream>
+
 namespace ivd::kitti {
     cv::Mat parseMatrix(const YAML::Node &input, int rows, int cols) {
         assert(input.IsSequence());
@@ -25,4 +27,21 @@ namespace ivd::kitti {
         buffer.resize(numPoints);
         return buffer;
     }
+
+    Oxts readOxts(const std::filesystem::path &file) {
+        std::ifstream input(file);
+        assert(input.is_open());
+
+        Oxts oxts;
+        for (auto &value: oxts.values) {
+            input >> value;
+        }
+        assert(!input.fail());
+        return oxts;
+    }
+
+    std::filesystem::path oxtsPath(const std::filesystem::path &imagePath) {
+        auto frame = imagePath.filename().replace_extension(".txt");
+        return imagePath.parent_path().parent_path().parent_path() / "oxts" / "data" / frame;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <array>
+#include <vector>
+
+namespace ivd::lidar {
+
+    /**
+     * Rolling buffer of the last sweeps with their poses, to get denser depth by projecting several sweeps.
+     * Sweeps are kept in the velodyne frame they were measured in (structure of arrays, one preallocated slot
+     * per sweep, the oldest is overwritten), and only transformed into the current frame when accumulating.
+     * Poses are velodyne -> world (4x4), eg chained with EgoMotion::transform.
+     */
+    class SweepAccumulator {
+    public:
+        explicit SweepAccumulator(size_t sweeps, size_t reservePoints = 150000);
+
+        void add(const float *xyzr, size_t count, const cv::Matx44d &pose);
+
+        void add(const std::vector<std::array<float, 4>> &points, const cv::Matx44d &pose);
+
+        /**
+         * All stored sweeps as x, y, z, reflectance in the velodyne frame at pose, as used by projectVelodyne.
+         * Reuses out. Returns the number of points.
+         */
+        size_t accumulate(const cv::Matx44d &pose, std::vector<float> &out) const;
+
+        // In the frame of the latest sweep
+        size_t accumulate(std::vector<float> &out) const;
+
+        void clear();
+
+        // Number of sweeps stored
+        size_t size() const {
+            return size_;
+        }
+
+        size_t capacity() const {
+            return sweeps_.size();
+        }
+
+        // Number of points stored
+        size_t points() const;
+
+    private:
+        struct Sweep {
+            std::vector<float> x, y, z, r;
+            cv::Matx44d pose;
+        };
+
+        std::vector<Sweep> sweeps_;
+        // Slot of the latest sweep
+        size_t head_{0};
+        size_t size_{0};
+    };
+}
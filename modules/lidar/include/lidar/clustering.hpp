@@ -0,0 +1,46 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace ivd::lidar {
+
+    struct ClusterOptions {
+        // Points closer than this (m) belong to the same cluster
+        float tolerance{0.5};
+        size_t minPoints{10};
+        size_t maxPoints{50000};
+    };
+
+    struct Cluster {
+        // Indices into the clustered points
+        std::vector<uint32_t> indices;
+        cv::Point3f centroid;
+        // Axis aligned bounds in the velodyne frame
+        cv::Point3f min;
+        cv::Point3f max;
+
+        cv::Point3f extent() const {
+            return max - min;
+        }
+    };
+
+    /**
+     * Euclidean clustering of raw x, y, z, reflectance points (best with the ground removed, see removeGround).
+     * Points are hashed into a grid of tolerance sized cells, so only the 27 neighbouring cells are searched.
+     * Neighbours are found in parallel and merged with a lock free union find.
+     * Clusters are ordered by size, largest first.
+     */
+    std::vector<Cluster> euclideanCluster(const float *xyzr, size_t count, const ClusterOptions &options = {});
+
+    /**
+     * Matches image boxes (eg detections) to clusters by the IoU of the box with the bounding rect of the
+     * cluster's points projected with T (3x4) into an image of size. Greedy, best IoU first, one cluster per box.
+     * Returns the cluster index per box, -1 when none overlaps by at least minIoU.
+     */
+    std::vector<int> associateClusters(const float *xyzr, const std::vector<Cluster> &clusters,
+                                       const std::vector<cv::Rect> &boxes, const cv::Mat &T, const cv::Size &size,
+                                       double minIoU = 0.3);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <array>
+#include <vector>
+
+namespace ivd::lidar {
+
+    // Constant velocity of the velodyne during a sweep, in the velodyne frame (m/s, rad/s)
+    struct EgoMotion {
+        cv::Vec3d linear;
+        cv::Vec3d angular;
+
+        /**
+         * From the IMU velocities (eg OXTS vf, vl, vu and wf, wl, wu) and the IMU -> velodyne rigid body
+         * transformation T_imu_velo (4x4 or 3x4). Accounts for the lever arm between the IMU and the velodyne.
+         */
+        static EgoMotion fromImu(const cv::Vec3d &linear, const cv::Vec3d &angular, const cv::Mat &T_imu_velo);
+
+        // Rigid body transformation (4x4) from the velodyne frame dt seconds later to the current one
+        cv::Matx44d transform(double dt) const;
+    };
+
+    struct DeskewOptions {
+        // Duration of one revolution (KITTI: 10Hz)
+        double sweepDuration{0.1};
+        // Rotation seen from above, the HDL-64E spins clockwise
+        bool clockwise{true};
+    };
+
+    /**
+     * Motion compensates a sweep in place, moving every point to where it would have been measured at the
+     * reference time. KITTI triggers the cameras when the scanner faces forward, so the reference is the
+     * +x direction and a point's time offset follows from its azimuth. First order correction,
+     * p' = p + t * (v + w x p), which is accurate at the rotation rates of a car within one sweep.
+     */
+    void deskew(float *xyzr, size_t count, const EgoMotion &motion, const DeskewOptions &options = {});
+
+    void deskew(std::vector<std::array<float, 4>> &points, const EgoMotion &motion,
+                const DeskewOptions &options = {});
+}
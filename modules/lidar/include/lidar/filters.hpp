@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+namespace ivd::lidar {
+
+    /**
+     * Voxel grid downsampling of raw x, y, z, reflectance points: every occupied voxel of voxelSize (m) is
+     * replaced by the mean of its points. Output is ordered by voxel. Returns the number of points in out.
+     */
+    size_t voxelDownsample(const float *xyzr, size_t count, float voxelSize, std::vector<float> &out);
+
+    std::vector<std::array<float, 4>> voxelDownsample(const std::vector<std::array<float, 4>> &points,
+                                                      float voxelSize);
+
+    struct GroundOptions {
+        // Grid cell size (m)
+        float cellSize{0.5};
+        // Points up to this high above the lowest point of their cell are ground
+        float heightThreshold{0.2};
+        // Cells whose lowest point is above this (velodyne frame, KITTI mounts it 1.73m high) have no ground
+        float maxGroundZ{-1.2};
+        // Grid extent around the sensor (m), points further out are kept
+        float range{80};
+    };
+
+    /**
+     * Removes ground points with a min height grid: per xy cell the lowest point is taken as the ground level.
+     * Cheaper than fitting planes and copes with sloped roads. Returns the number of points in out.
+     */
+    size_t removeGround(const float *xyzr, size_t count, const GroundOptions &options, std::vector<float> &out);
+
+    std::vector<std::array<float, 4>> removeGround(const std::vector<std::array<float, 4>> &points,
+                                                   const GroundOptions &options = {});
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <array>
+#include <vector>
+
+namespace ivd::lidar {
+
+    /**
+     * Camera view frustum in velodyne space, derived from the velodyne -> image projection T (3x4) and the
+     * image size. A point is in view when it is in front of the camera and projects inside the image,
+     * which comes down to 5 half-space tests on the homogeneous point (no projection needed).
+     * Points exactly on the image border count as outside.
+     */
+    class FrustumCuller {
+    public:
+        FrustumCuller(const cv::Mat &T, const cv::Size &size, double nearPlane = 0);
+
+        bool contains(float x, float y, float z) const {
+            for (auto &plane: planes_) {
+                if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] <= 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Rows (Nx3 or Nx4, CV_32F or CV_64F) in view
+        cv::Mat cull(const cv::Mat &points) const;
+
+        // Raw x, y, z, reflectance points in view, appended to out
+        size_t cull(const float *xyzr, size_t count, std::vector<float> &out) const;
+
+    private:
+        // Near, left, right, top, bottom. Inside when dot > 0
+        std::array<cv::Vec4f, 5> planes_;
+    };
+}
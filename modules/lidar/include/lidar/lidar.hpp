@@ -2,17 +2,72 @@
 
 #include <opencv2/opencv.hpp>
 
+#include <array>
+#include <vector>
+
 namespace ivd::lidar {
 
-    cv::Mat makeHomogeneous(const cv::Mat &points);
+    // Points projected into an image, in a structure of arrays layout
+    struct ProjectedPoints {
+        std::vector<float> u;
+        std::vector<float> v;
+        std::vector<float> z;
+
+        size_t size() const {
+            return z.size();
+        }
+
+        bool empty() const {
+            return z.empty();
+        }
+
+        void resize(size_t size);
+
+        // 3xN CV_64F matrix (u, v, z rows), as returned by project
+        cv::Mat toMat() const;
+    };
 
-    // TODO: Optimize by removing points that are not possibly in view (eg only positive X for forward looking camera)
+    cv::Mat makeHomogeneous(const cv::Mat &points);
 
+    /**
+     * With a size, points outside of the camera frustum are culled before projecting (see FrustumCuller):
+     * only points in front of the camera (z > 0) that project strictly inside the image (0 < u < width,
+     * 0 < v < height) are returned. Points behind the camera and on the image border are dropped.
+     */
     cv::Mat project(const cv::Mat &homogeneous, const cv::Mat &T, const cv::Size &size = {});
 
+    /**
+     * Projects raw velodyne points (x, y, z, reflectance) with T (3x4) in a single pass, dropping points
+     * behind the camera or outside of the image. Replaces makeHomogeneous + project.
+     */
+    void projectVelodyne(const float *xyzr, size_t count, const cv::Mat &T, const cv::Size &size,
+                         ProjectedPoints &out);
+
+    ProjectedPoints projectVelodyne(const std::vector<std::array<float, 4>> &points, const cv::Mat &T,
+                                    const cv::Size &size);
+
     cv::Mat depthMapFromProjectedPoints(const cv::Mat &points, cv::Size size);
 
+    struct SplatOptions {
+        // Each point covers the (2 * radius + 1)^2 pixels around it
+        int radius{0};
+        bool parallel{true};
+    };
+
+    /**
+     * Z-buffered depth map (CV_64F, 0 == no depth): when several points cover a pixel the nearest one wins,
+     * so background points do not show through foreground objects. The parallel version splits the image
+     * into row bands, every band only writes its own rows so the result is the same as the serial one.
+     */
+    cv::Mat depthMapFromProjectedPoints(const ProjectedPoints &points, const cv::Size &size,
+                                        const SplatOptions &options = {});
+
+    // Median depth in bbox of a depth map in any of the common/depth_format.hpp formats
     std::optional<double> getDepth(const cv::Mat &lidarPoints, const cv::Rect &bbox);
 
     std::optional<double> getDepth(const cv::Mat &depthMap, const cv::Rect &bbox, const cv::Mat &mask);
+
+    // Depths of all boxes of a frame in parallel, masks are empty or one (possibly empty) per box
+    std::vector<std::optional<double>> getDepths(const cv::Mat &depthMap, const std::vector<cv::Rect> &boxes,
+                                                 const std::vector<cv::Mat> &masks = {});
 }
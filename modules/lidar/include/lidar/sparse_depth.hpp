@@ -0,0 +1,83 @@
+#pragma once
+
+#include <lidar/lidar.hpp>
+
+#include <opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+namespace ivd::lidar {
+
+    /**
+     * Sparse depth map, the projected points bucketed by image row (CSR) and sorted by column within a row.
+     * Holds one depth per pixel, by default with the same semantics as depthMapFromProjectedPoints (the last
+     * point hitting a pixel wins), so queries give the same results as on the dense map while only touching
+     * the points inside the box. Use toDense() for visualization.
+     */
+    class SparseDepthMap {
+    public:
+        // Which point to keep when several hit the same pixel
+        enum class Keep {
+            Last,
+            // Z-buffer, as depthMapFromProjectedPoints with SplatOptions
+            Nearest
+        };
+
+        SparseDepthMap() = default;
+
+        SparseDepthMap(const ProjectedPoints &points, const cv::Size &size, Keep keep = Keep::Last);
+
+        // Rebuilds from points, reusing the buffers
+        void assign(const ProjectedPoints &points, const cv::Size &size, Keep keep = Keep::Last);
+
+        const cv::Size &size() const {
+            return size_;
+        }
+
+        // Number of pixels with a depth
+        size_t count() const {
+            return depths_.size();
+        }
+
+        /**
+         * Calls fn(col, row, depth) for every pixel with a depth inside bbox (clipped to the map),
+         * in row-major order
+         */
+        template<class Fn>
+        void forEach(const cv::Rect &bbox, Fn &&fn) const {
+            auto clipped = bbox & cv::Rect({}, size_);
+            for (int row = clipped.y; row < clipped.br().y; row++) {
+                auto first = cols_.begin() + rowOffsets_[row];
+                auto last = cols_.begin() + rowOffsets_[row + 1];
+                auto it = std::lower_bound(first, last, clipped.x);
+                for (; it != last && *it < clipped.br().x; ++it) {
+                    fn(*it, row, depths_[it - cols_.begin()]);
+                }
+            }
+        }
+
+        std::optional<double> getDepth(const cv::Rect &bbox) const;
+
+        // Mask (CV_8U) has the size of bbox, only pixels where it is set count. An empty mask counts everything
+        std::optional<double> getDepth(const cv::Rect &bbox, const cv::Mat &mask) const;
+
+        // Depths of all boxes of a frame in parallel, masks are empty or one (possibly empty) per box
+        std::vector<std::optional<double>> getDepths(const std::vector<cv::Rect> &boxes,
+                                                     const std::vector<cv::Mat> &masks = {}) const;
+
+        // Dense CV_64F depth map, same as depthMapFromProjectedPoints
+        cv::Mat toDense() const;
+
+    private:
+        cv::Size size_;
+        std::vector<int> rowOffsets_;
+        std::vector<int> cols_;
+        std::vector<float> depths_;
+
+        // Build scratch
+        std::vector<int> order_;
+        std::vector<int> next_;
+    };
+}
@@ -1,14 +1,42 @@
 #pragma once
 
+#include <lidar/lidar.hpp>
+
 #include <opencv2/opencv.hpp>
 
+#include <algorithm>
+#include <array>
+
 namespace ivd::lidar {
 
     void visualizeLidarPoints(cv::Mat &image, const cv::Mat &points, const std::string &palette = "jet",
                               double maxDistance = 50);
 
+    // Depth map in any of the common/depth_format.hpp formats, the size of image. Clips bbox (and mask) to the image
     void visualizeLidarDepthForBBox(cv::Mat &image, const cv::Mat &depthMap, const cv::Rect &bbox,
                                     const cv::Mat &mask = cv::Mat(),
                                     const std::string &palette = "jet",
                                     double maxDistance = 50);
+
+    // Palette sampled at 256 distances over [0, maxDistance], BGR
+    struct ColorLut {
+        ColorLut(const std::string &palette, double maxDistance);
+
+        const cv::Vec3b &operator()(double z) const {
+            auto i = int(z * scale_ + 0.5);
+            return colors_[std::clamp(i, 0, 255)];
+        }
+
+    private:
+        std::array<cv::Vec3b, 256> colors_;
+        double scale_;
+    };
+
+    /**
+     * Fast version of visualizeLidarPoints for CV_8UC3 images: colors come from a ColorLut and every point
+     * is written as a small cross (center and its 4 neighbours, like a radius 1 circle) straight into the
+     * image, in parallel over row bands. Later points overwrite earlier ones, as with cv::circle.
+     */
+    void renderLidarPoints(cv::Mat &image, const ProjectedPoints &points, const std::string &palette = "jet",
+                           double maxDistance = 50);
 }
@@ -0,0 +1,87 @@
+#include <lidar/accumulator.hpp>
+
+namespace ivd::lidar {
+
+    SweepAccumulator::SweepAccumulator(size_t sweeps, size_t reservePoints) : sweeps_(sweeps) {
+        assert(sweeps > 0);
+        for (auto &sweep: sweeps_) {
+            sweep.x.reserve(reservePoints);
+            sweep.y.reserve(reservePoints);
+            sweep.z.reserve(reservePoints);
+            sweep.r.reserve(reservePoints);
+        }
+    }
+
+    void SweepAccumulator::add(const float *xyzr, size_t count, const cv::Matx44d &pose) {
+        head_ = size_ == 0 ? 0 : (head_ + 1) % sweeps_.size();
+        size_ = std::min(size_ + 1, sweeps_.size());
+
+        // Deinterleave into the slot, does not allocate below the reserved size
+        auto &sweep = sweeps_[head_];
+        sweep.pose = pose;
+        sweep.x.resize(count);
+        sweep.y.resize(count);
+        sweep.z.resize(count);
+        sweep.r.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            sweep.x[i] = xyzr[4 * i];
+            sweep.y[i] = xyzr[4 * i + 1];
+            sweep.z[i] = xyzr[4 * i + 2];
+            sweep.r[i] = xyzr[4 * i + 3];
+        }
+    }
+
+    void SweepAccumulator::add(const std::vector<std::array<float, 4>> &points, const cv::Matx44d &pose) {
+        add(reinterpret_cast<const float *>(points.data()), points.size(), pose);
+    }
+
+    size_t SweepAccumulator::accumulate(const cv::Matx44d &pose, std::vector<float> &out) const {
+        out.resize(4 * points());
+
+        // Sweep -> world -> pose, one transformation per sweep
+        auto worldToPose = pose.inv();
+        size_t offset = 0;
+        for (size_t k = 0; k < size_; k++) {
+            auto &sweep = sweeps_[(head_ + sweeps_.size() - k) % sweeps_.size()];
+            cv::Matx44f T = worldToPose * sweep.pose;
+            float *dst = out.data() + 4 * offset;
+
+            cv::parallel_for_(cv::Range(0, int(sweep.x.size())), [&](const cv::Range &range) {
+                for (int i = range.start; i < range.end; i++) {
+                    const float x = sweep.x[i];
+                    const float y = sweep.y[i];
+                    const float z = sweep.z[i];
+                    float *p = dst + 4 * size_t(i);
+                    p[0] = T(0, 0) * x + T(0, 1) * y + T(0, 2) * z + T(0, 3);
+                    p[1] = T(1, 0) * x + T(1, 1) * y + T(1, 2) * z + T(1, 3);
+                    p[2] = T(2, 0) * x + T(2, 1) * y + T(2, 2) * z + T(2, 3);
+                    p[3] = sweep.r[i];
+                }
+            }, double(sweep.x.size()) / 16384);
+
+            offset += sweep.x.size();
+        }
+        return offset;
+    }
+
+    size_t SweepAccumulator::accumulate(std::vector<float> &out) const {
+        if (size_ == 0) {
+            out.clear();
+            return 0;
+        }
+        return accumulate(sweeps_[head_].pose, out);
+    }
+
+    void SweepAccumulator::clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+
+    size_t SweepAccumulator::points() const {
+        size_t count = 0;
+        for (size_t k = 0; k < size_; k++) {
+            count += sweeps_[(head_ + sweeps_.size() - k) % sweeps_.size()].x.size();
+        }
+        return count;
+    }
+}
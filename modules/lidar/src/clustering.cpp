@@ -0,0 +1,239 @@
+#include <lidar/clustering.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+namespace ivd::lidar {
+
+    namespace {
+        // 21 bits per axis
+        constexpr int64_t cellOffset = 1 << 20;
+
+        inline uint64_t cellKey(int64_t x, int64_t y, int64_t z) {
+            constexpr uint64_t mask = (1 << 21) - 1;
+            return (uint64_t(x + cellOffset) & mask) << 42 | (uint64_t(y + cellOffset) & mask) << 21 |
+                   (uint64_t(z + cellOffset) & mask);
+        }
+
+        inline cv::Vec3i cellCoordinates(uint64_t key) {
+            constexpr uint64_t mask = (1 << 21) - 1;
+            return {int(int64_t(key >> 42 & mask) - cellOffset), int(int64_t(key >> 21 & mask) - cellOffset),
+                    int(int64_t(key & mask) - cellOffset)};
+        }
+
+        // Lock free union find, roots link to the smaller index
+        class UnionFind {
+        public:
+            explicit UnionFind(size_t size) : parents_(size) {
+                for (size_t i = 0; i < size; i++) {
+                    parents_[i].store(uint32_t(i), std::memory_order_relaxed);
+                }
+            }
+
+            uint32_t find(uint32_t i) {
+                while (true) {
+                    auto parent = parents_[i].load(std::memory_order_relaxed);
+                    if (parent == i) {
+                        return i;
+                    }
+                    // Path halving
+                    auto grandParent = parents_[parent].load(std::memory_order_relaxed);
+                    parents_[i].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+                    i = grandParent;
+                }
+            }
+
+            void unite(uint32_t a, uint32_t b) {
+                while (true) {
+                    a = find(a);
+                    b = find(b);
+                    if (a == b) {
+                        return;
+                    }
+                    if (a < b) {
+                        std::swap(a, b);
+                    }
+                    auto expected = a;
+                    if (parents_[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) {
+                        return;
+                    }
+                }
+            }
+
+        private:
+            std::vector<std::atomic<uint32_t>> parents_;
+        };
+    }
+
+    std::vector<Cluster> euclideanCluster(const float *xyzr, size_t count, const ClusterOptions &options) {
+        assert(options.tolerance > 0);
+        const float inverseSize = 1 / options.tolerance;
+        const float tolerance2 = options.tolerance * options.tolerance;
+
+        // Sort the points by cell, then index the cells
+        std::vector<std::pair<uint64_t, uint32_t>> keys(count);
+        for (size_t i = 0; i < count; i++) {
+            const float *p = xyzr + 4 * i;
+            keys[i] = {cellKey(int64_t(std::floor(p[0] * inverseSize)), int64_t(std::floor(p[1] * inverseSize)),
+                               int64_t(std::floor(p[2] * inverseSize))), uint32_t(i)};
+        }
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<uint64_t> cells;
+        std::vector<uint32_t> cellOffsets;
+        for (size_t i = 0; i < count; i++) {
+            if (i == 0 || keys[i].first != keys[i - 1].first) {
+                cells.push_back(keys[i].first);
+                cellOffsets.push_back(uint32_t(i));
+            }
+        }
+        cellOffsets.push_back(uint32_t(count));
+
+        // Connect every point to its neighbours within tolerance, in parallel over cells
+        UnionFind sets(count);
+        cv::parallel_for_(cv::Range(0, int(cells.size())), [&](const cv::Range &range) {
+            for (int cell = range.start; cell < range.end; cell++) {
+                auto c = cellCoordinates(cells[cell]);
+                for (int dx = -1; dx <= 1; dx++) {
+                    for (int dy = -1; dy <= 1; dy++) {
+                        for (int dz = -1; dz <= 1; dz++) {
+                            // Each pair of cells once
+                            auto key = cellKey(c[0] + dx, c[1] + dy, c[2] + dz);
+                            if (key < cells[cell]) {
+                                continue;
+                            }
+                            auto it = std::lower_bound(cells.begin(), cells.end(), key);
+                            if (it == cells.end() || *it != key) {
+                                continue;
+                            }
+                            auto other = int(it - cells.begin());
+
+                            for (auto i = cellOffsets[cell]; i < cellOffsets[cell + 1]; i++) {
+                                auto a = keys[i].second;
+                                const float *pa = xyzr + 4 * size_t(a);
+                                auto first = other == cell ? i + 1 : cellOffsets[other];
+                                for (auto j = first; j < cellOffsets[other + 1]; j++) {
+                                    auto b = keys[j].second;
+                                    const float *pb = xyzr + 4 * size_t(b);
+                                    float x = pa[0] - pb[0];
+                                    float y = pa[1] - pb[1];
+                                    float z = pa[2] - pb[2];
+                                    if (x * x + y * y + z * z <= tolerance2) {
+                                        sets.unite(a, b);
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        });
+
+        // Gather the sets
+        std::vector<uint32_t> roots(count);
+        std::vector<uint32_t> sizes(count, 0);
+        for (uint32_t i = 0; i < count; i++) {
+            roots[i] = sets.find(i);
+            sizes[roots[i]]++;
+        }
+
+        std::vector<int> clusterIndex(count, -1);
+        std::vector<Cluster> clusters;
+        for (uint32_t i = 0; i < count; i++) {
+            auto root = roots[i];
+            if (sizes[root] < options.minPoints || sizes[root] > options.maxPoints) {
+                continue;
+            }
+            if (clusterIndex[root] < 0) {
+                clusterIndex[root] = int(clusters.size());
+                clusters.emplace_back();
+                clusters.back().indices.reserve(sizes[root]);
+            }
+            clusters[clusterIndex[root]].indices.push_back(i);
+        }
+
+        for (auto &cluster: clusters) {
+            cv::Point3d sum;
+            cluster.min = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                           std::numeric_limits<float>::max()};
+            cluster.max = -cluster.min;
+            for (auto i: cluster.indices) {
+                cv::Point3f p(xyzr[4 * size_t(i)], xyzr[4 * size_t(i) + 1], xyzr[4 * size_t(i) + 2]);
+                sum += cv::Point3d(p);
+                cluster.min = {std::min(cluster.min.x, p.x), std::min(cluster.min.y, p.y), std::min(cluster.min.z, p.z)};
+                cluster.max = {std::max(cluster.max.x, p.x), std::max(cluster.max.y, p.y), std::max(cluster.max.z, p.z)};
+            }
+            cluster.centroid = cv::Point3f(sum / double(cluster.indices.size()));
+        }
+
+        std::stable_sort(clusters.begin(), clusters.end(),
+                         [](auto &a, auto &b) { return a.indices.size() > b.indices.size(); });
+        return clusters;
+    }
+
+    std::vector<int> associateClusters(const float *xyzr, const std::vector<Cluster> &clusters,
+                                       const std::vector<cv::Rect> &boxes, const cv::Mat &T, const cv::Size &size,
+                                       double minIoU) {
+        assert(T.size() == cv::Size(4, 3));
+        cv::Matx34d t;
+        T.convertTo(cv::Mat(t, false), CV_64F);
+        const cv::Rect image({}, size);
+
+        // Image footprint of every cluster, from its points in front of the camera
+        std::vector<cv::Rect> footprints(clusters.size());
+        cv::parallel_for_(cv::Range(0, int(clusters.size())), [&](const cv::Range &range) {
+            for (int c = range.start; c < range.end; c++) {
+                double u0 = std::numeric_limits<double>::max(), v0 = u0, u1 = -u0, v1 = -u0;
+                for (auto i: clusters[c].indices) {
+                    cv::Vec4d p(xyzr[4 * size_t(i)], xyzr[4 * size_t(i) + 1], xyzr[4 * size_t(i) + 2], 1);
+                    auto uvw = t * p;
+                    if (uvw[2] <= 0) {
+                        continue;
+                    }
+                    auto u = uvw[0] / uvw[2];
+                    auto v = uvw[1] / uvw[2];
+                    u0 = std::min(u0, u);
+                    v0 = std::min(v0, v);
+                    u1 = std::max(u1, u);
+                    v1 = std::max(v1, v);
+                }
+                if (u1 >= u0) {
+                    footprints[c] = cv::Rect(cv::Point(int(std::floor(u0)), int(std::floor(v0))),
+                                             cv::Point(int(std::ceil(u1)) + 1, int(std::ceil(v1)) + 1)) & image;
+                }
+            }
+        });
+
+        struct Match {
+            double iou;
+            int box;
+            int cluster;
+        };
+        std::vector<Match> matches;
+        for (int b = 0; b < int(boxes.size()); b++) {
+            for (int c = 0; c < int(clusters.size()); c++) {
+                auto intersection = double((boxes[b] & footprints[c]).area());
+                if (intersection <= 0) {
+                    continue;
+                }
+                auto iou = intersection / (boxes[b].area() + footprints[c].area() - intersection);
+                if (iou >= minIoU) {
+                    matches.push_back({iou, b, c});
+                }
+            }
+        }
+        std::stable_sort(matches.begin(), matches.end(), [](auto &a, auto &b) { return a.iou > b.iou; });
+
+        std::vector<int> result(boxes.size(), -1);
+        std::vector<bool> used(clusters.size(), false);
+        for (auto &match: matches) {
+            if (result[match.box] < 0 && !used[match.cluster]) {
+                result[match.box] = match.cluster;
+                used[match.cluster] = true;
+            }
+        }
+        return result;
+    }
+}
@@ -0,0 +1,57 @@
+#include <lidar/deskew.hpp>
+
+namespace ivd::lidar {
+
+    EgoMotion EgoMotion::fromImu(const cv::Vec3d &linear, const cv::Vec3d &angular, const cv::Mat &T_imu_velo) {
+        assert(T_imu_velo.type() == CV_64F);
+        assert(T_imu_velo.cols == 4 && (T_imu_velo.rows == 3 || T_imu_velo.rows == 4));
+
+        cv::Matx33d R;
+        T_imu_velo(cv::Rect(0, 0, 3, 3)).copyTo(R);
+        cv::Vec3d t(T_imu_velo.at<double>(0, 3), T_imu_velo.at<double>(1, 3), T_imu_velo.at<double>(2, 3));
+
+        // Velodyne origin in the IMU frame, it moves with v + w x r
+        cv::Vec3d origin = -(R.t() * t);
+        return {R * (linear + angular.cross(origin)), R * angular};
+    }
+
+    cv::Matx44d EgoMotion::transform(double dt) const {
+        cv::Matx33d R;
+        cv::Rodrigues(angular * dt, R);
+        auto t = linear * dt;
+        return {R(0, 0), R(0, 1), R(0, 2), t[0],
+                R(1, 0), R(1, 1), R(1, 2), t[1],
+                R(2, 0), R(2, 1), R(2, 2), t[2],
+                0, 0, 0, 1};
+    }
+
+    void deskew(float *xyzr, size_t count, const EgoMotion &motion, const DeskewOptions &options) {
+        // Time per degree of azimuth, relative to facing forward
+        const float direction = options.clockwise ? -1.f : 1.f;
+        const auto timePerDegree = float(direction * options.sweepDuration / 360.0);
+        const auto v = cv::Vec3f(motion.linear);
+        const auto w = cv::Vec3f(motion.angular);
+
+        cv::parallel_for_(cv::Range(0, int(count)), [&](const cv::Range &range) {
+            for (int i = range.start; i < range.end; i++) {
+                float *p = xyzr + 4 * size_t(i);
+                const float x = p[0];
+                const float y = p[1];
+                const float z = p[2];
+
+                // fastAtan2 is [0, 360), make it (-180, 180]
+                float azimuth = cv::fastAtan2(y, x);
+                azimuth -= azimuth > 180.f ? 360.f : 0.f;
+                const float t = azimuth * timePerDegree;
+
+                p[0] = x + t * (v[0] + w[1] * z - w[2] * y);
+                p[1] = y + t * (v[1] + w[2] * x - w[0] * z);
+                p[2] = z + t * (v[2] + w[0] * y - w[1] * x);
+            }
+        }, double(count) / 16384);
+    }
+
+    void deskew(std::vector<std::array<float, 4>> &points, const EgoMotion &motion, const DeskewOptions &options) {
+        deskew(reinterpret_cast<float *>(points.data()), points.size(), motion, options);
+    }
+}
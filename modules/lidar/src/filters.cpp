@@ -0,0 +1,112 @@
+#include <lidar/filters.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace ivd::lidar {
+
+    namespace {
+        // 21 bits per axis, +-1M voxels around the sensor
+        inline uint64_t voxelKey(float x, float y, float z, float inverseSize) {
+            constexpr int64_t offset = 1 << 20;
+            constexpr uint64_t mask = (1 << 21) - 1;
+            auto ix = uint64_t(int64_t(std::floor(x * inverseSize)) + offset) & mask;
+            auto iy = uint64_t(int64_t(std::floor(y * inverseSize)) + offset) & mask;
+            auto iz = uint64_t(int64_t(std::floor(z * inverseSize)) + offset) & mask;
+            return (ix << 42) | (iy << 21) | iz;
+        }
+
+        std::vector<std::array<float, 4>> toPoints(const std::vector<float> &xyzr, size_t count) {
+            std::vector<std::array<float, 4>> result(count);
+            std::copy(xyzr.begin(), xyzr.begin() + 4 * count, reinterpret_cast<float *>(result.data()));
+            return result;
+        }
+    }
+
+    size_t voxelDownsample(const float *xyzr, size_t count, float voxelSize, std::vector<float> &out) {
+        assert(voxelSize > 0);
+        const float inverseSize = 1 / voxelSize;
+
+        // Sort by voxel, points of a voxel end up next to each other
+        std::vector<std::pair<uint64_t, uint32_t>> keys(count);
+        for (size_t i = 0; i < count; i++) {
+            const float *p = xyzr + 4 * i;
+            keys[i] = {voxelKey(p[0], p[1], p[2], inverseSize), uint32_t(i)};
+        }
+        std::sort(keys.begin(), keys.end());
+
+        out.clear();
+        out.reserve(4 * count);
+        for (size_t first = 0; first < count;) {
+            size_t last = first;
+            double sum[4]{0, 0, 0, 0};
+            for (; last < count && keys[last].first == keys[first].first; last++) {
+                const float *p = xyzr + 4 * size_t(keys[last].second);
+                sum[0] += p[0];
+                sum[1] += p[1];
+                sum[2] += p[2];
+                sum[3] += p[3];
+            }
+            auto n = double(last - first);
+            for (auto s: sum) {
+                out.push_back(float(s / n));
+            }
+            first = last;
+        }
+        return out.size() / 4;
+    }
+
+    std::vector<std::array<float, 4>> voxelDownsample(const std::vector<std::array<float, 4>> &points,
+                                                      float voxelSize) {
+        std::vector<float> out;
+        auto count = voxelDownsample(reinterpret_cast<const float *>(points.data()), points.size(), voxelSize, out);
+        return toPoints(out, count);
+    }
+
+    size_t removeGround(const float *xyzr, size_t count, const GroundOptions &options, std::vector<float> &out) {
+        assert(options.cellSize > 0 && options.range > 0);
+        const float inverseSize = 1 / options.cellSize;
+        const int cells = int(std::ceil(2 * options.range * inverseSize));
+
+        auto cellIndex = [&](const float *p) {
+            auto cx = int(std::floor((p[0] + options.range) * inverseSize));
+            auto cy = int(std::floor((p[1] + options.range) * inverseSize));
+            return (cx >= 0 && cx < cells && cy >= 0 && cy < cells) ? cy * cells + cx : -1;
+        };
+
+        // Lowest point per cell
+        std::vector<float> minZ(size_t(cells) * cells, std::numeric_limits<float>::max());
+        for (size_t i = 0; i < count; i++) {
+            const float *p = xyzr + 4 * i;
+            auto cell = cellIndex(p);
+            if (cell >= 0) {
+                minZ[cell] = std::min(minZ[cell], p[2]);
+            }
+        }
+
+        // Keep what is above ground (branchless compaction)
+        out.resize(4 * count);
+        size_t n = 0;
+        for (size_t i = 0; i < count; i++) {
+            const float *p = xyzr + 4 * i;
+            auto cell = cellIndex(p);
+            float ground = cell >= 0 ? minZ[cell] : std::numeric_limits<float>::max();
+            bool isGround = ground <= options.maxGroundZ && p[2] - ground <= options.heightThreshold;
+
+            std::copy(p, p + 4, out.data() + 4 * n);
+            n += !isGround;
+        }
+        out.resize(4 * n);
+        return n;
+    }
+
+    std::vector<std::array<float, 4>> removeGround(const std::vector<std::array<float, 4>> &points,
+                                                   const GroundOptions &options) {
+        std::vector<float> out;
+        auto count = removeGround(reinterpret_cast<const float *>(points.data()), points.size(), options, out);
+        return toPoints(out, count);
+    }
+}
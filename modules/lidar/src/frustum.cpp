@@ -0,0 +1,76 @@
+#include <lidar/frustum.hpp>
+
+namespace {
+    template<class T>
+    cv::Mat cullRows(const ivd::lidar::FrustumCuller &culler, const cv::Mat &points) {
+        std::vector<int> visible;
+        visible.reserve(points.rows);
+        for (int i = 0; i < points.rows; i++) {
+            auto *p = points.ptr<T>(i);
+            if (culler.contains(float(p[0]), float(p[1]), float(p[2]))) {
+                visible.push_back(i);
+            }
+        }
+
+        cv::Mat result(int(visible.size()), points.cols, points.type());
+        for (int i = 0; i < int(visible.size()); i++) {
+            points.row(visible[i]).copyTo(result.row(i));
+        }
+        return result;
+    }
+}
+
+namespace ivd::lidar {
+
+    FrustumCuller::FrustumCuller(const cv::Mat &T, const cv::Size &size, double nearPlane) {
+        assert(T.size() == cv::Size(4, 3));
+        assert(size.width > 0 && size.height > 0);
+
+        cv::Matx34d t;
+        T.convertTo(cv::Mat(t, false), CV_64F);
+        cv::Vec4d r0(t(0, 0), t(0, 1), t(0, 2), t(0, 3));
+        cv::Vec4d r1(t(1, 0), t(1, 1), t(1, 2), t(1, 3));
+        cv::Vec4d r2(t(2, 0), t(2, 1), t(2, 2), t(2, 3));
+
+        // With w = r2.X > 0: u = r0.X / w >= 0 <=> r0.X >= 0 and u < width <=> (width * r2 - r0).X > 0
+        planes_ = {
+                cv::Vec4f(r2 - cv::Vec4d(0, 0, 0, nearPlane)),
+                cv::Vec4f(r0),
+                cv::Vec4f(size.width * r2 - r0),
+                cv::Vec4f(r1),
+                cv::Vec4f(size.height * r2 - r1),
+        };
+    }
+
+    cv::Mat FrustumCuller::cull(const cv::Mat &points) const {
+        assert(points.channels() == 1);
+        assert(points.cols == 3 || points.cols == 4);
+
+        switch (points.depth()) {
+            case CV_32F:
+                return cullRows<float>(*this, points);
+            case CV_64F:
+                return cullRows<double>(*this, points);
+            default:
+                assert(false);
+                return {};
+        }
+    }
+
+    size_t FrustumCuller::cull(const float *xyzr, size_t count, std::vector<float> &out) const {
+        auto start = out.size();
+        out.resize(start + 4 * count);
+        auto *dst = out.data() + start;
+
+        // Write every point, only advance for the ones in view
+        size_t n = 0;
+        for (size_t i = 0; i < count; i++) {
+            const float *p = xyzr + 4 * i;
+            std::copy(p, p + 4, dst + 4 * n);
+            n += contains(p[0], p[1], p[2]);
+        }
+
+        out.resize(start + 4 * n);
+        return n;
+    }
+}
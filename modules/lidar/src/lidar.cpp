@@ -1,9 +1,30 @@
 #include <lidar/lidar.hpp>
+#include <lidar/frustum.hpp>
 
+#include <common/depth_format.hpp>
 #include <common/opencv_utils.hpp>
 
+#include <algorithm>
+
 namespace ivd::lidar {
 
+    void ProjectedPoints::resize(size_t size) {
+        u.resize(size);
+        v.resize(size);
+        z.resize(size);
+    }
+
+    cv::Mat ProjectedPoints::toMat() const {
+        cv::Mat result(3, int(size()), CV_64F);
+        if (empty()) {
+            return result;
+        }
+        cv::Mat(1, int(size()), CV_32F, (void *) u.data()).convertTo(result.row(0), CV_64F);
+        cv::Mat(1, int(size()), CV_32F, (void *) v.data()).convertTo(result.row(1), CV_64F);
+        cv::Mat(1, int(size()), CV_32F, (void *) z.data()).convertTo(result.row(2), CV_64F);
+        return result;
+    }
+
     cv::Mat makeHomogeneous(const cv::Mat &points) {
         assert(points.channels() == 1);
         assert(points.cols == 3);
@@ -29,6 +50,19 @@ namespace ivd::lidar {
         assert(homogeneous.cols == 4);
         assert(T.size() == cv::Size(4, 3));
 
+        if (size.width > 0 && size.height > 0) {
+            // Only project the points in view, this also drops Z <= 0 (avoids divide by 0)
+            auto visible = FrustumCuller(T, size).cull(homogeneous);
+            if (visible.empty()) {
+                return cv::Mat(3, 0, homogeneous.type());
+            }
+
+            cv::Mat veloUVZ = T * visible.t();
+            veloUVZ.row(0) /= veloUVZ.row(2);
+            veloUVZ.row(1) /= veloUVZ.row(2);
+            return veloUVZ;
+        }
+
         cv::Mat veloUVZ = T * homogeneous.t();
         assert(veloUVZ.rows == 3);
         assert(veloUVZ.cols == homogeneous.rows);
@@ -38,27 +72,51 @@ namespace ivd::lidar {
         // Divide U,V by Z
         veloUVZ.row(0) /= veloUVZ.row(2);
         veloUVZ.row(1) /= veloUVZ.row(2);
+        return veloUVZ;
+    }
 
-        if (size.width > 0 && size.height > 0) {
-            cv::Mat result;
-            for (size_t i = 0; i < veloUVZ.cols; i++) {
-                auto col = veloUVZ.col(i);
-
-                auto u = col.at<double>(0);
-                auto v = col.at<double>(1);
-
-                // Skip out of range UV coordinates
-                if (u < 0 || u > size.width || v < 0 || v > size.height) {
-                    continue;
-                }
+    void projectVelodyne(const float *xyzr, size_t count, const cv::Mat &T, const cv::Size &size,
+                         ProjectedPoints &out) {
+        assert(T.size() == cv::Size(4, 3));
+        assert(size.width > 0 && size.height > 0);
+
+        cv::Matx34f t;
+        T.convertTo(cv::Mat(t, false), CV_32F);
+
+        // Write every point, only advance the output for the ones in view (branchless compaction)
+        out.resize(count);
+        auto *pu = out.u.data();
+        auto *pv = out.v.data();
+        auto *pz = out.z.data();
+        const auto width = float(size.width);
+        const auto height = float(size.height);
+
+        size_t n = 0;
+        for (size_t i = 0; i < count; i++) {
+            const float *p = xyzr + 4 * i;
+            const float x = p[0];
+            const float y = p[1];
+            const float z = p[2];
+
+            const float w = t(2, 0) * x + t(2, 1) * y + t(2, 2) * z + t(2, 3);
+            const float inv = 1.f / w;
+            const float u = (t(0, 0) * x + t(0, 1) * y + t(0, 2) * z + t(0, 3)) * inv;
+            const float v = (t(1, 0) * x + t(1, 1) * y + t(1, 2) * z + t(1, 3)) * inv;
+
+            pu[n] = u;
+            pv[n] = v;
+            pz[n] = w;
+            n += (w > 0) & (u >= 0) & (u < width) & (v >= 0) & (v < height);
+        }
 
-                result.push_back(col.t());
-            }
+        out.resize(n);
+    }
 
-            return result.t();
-        } else {
-            return veloUVZ;
-        }
+    ProjectedPoints projectVelodyne(const std::vector<std::array<float, 4>> &points, const cv::Mat &T,
+                                    const cv::Size &size) {
+        ProjectedPoints result;
+        projectVelodyne(reinterpret_cast<const float *>(points.data()), points.size(), T, size, result);
+        return result;
     }
 
     cv::Mat depthMapFromProjectedPoints(const cv::Mat &points, cv::Size size) {
@@ -81,15 +139,96 @@ namespace ivd::lidar {
         return result;
     }
 
+    namespace {
+        inline void splat(cv::Mat &depthMap, int u, int v, double z, int radius, int rowBegin, int rowEnd) {
+            auto r0 = std::max(v - radius, rowBegin);
+            auto r1 = std::min(v + radius + 1, rowEnd);
+            auto c0 = std::max(u - radius, 0);
+            auto c1 = std::min(u + radius + 1, depthMap.cols);
+            for (int row = r0; row < r1; row++) {
+                auto *out = depthMap.ptr<double>(row);
+                for (int col = c0; col < c1; col++) {
+                    // 0 is empty
+                    if (out[col] == 0 || z < out[col]) {
+                        out[col] = z;
+                    }
+                }
+            }
+        }
+    }
+
+    cv::Mat depthMapFromProjectedPoints(const ProjectedPoints &points, const cv::Size &size,
+                                        const SplatOptions &options) {
+        assert(options.radius >= 0);
+
+        cv::Mat result(size, CV_64F, cv::Scalar(0));
+        const auto radius = options.radius;
+
+        if (!options.parallel) {
+            for (size_t i = 0; i < points.size(); i++) {
+                if (points.z[i] > 0) {
+                    splat(result, int(points.u[i]), int(points.v[i]), points.z[i], radius, 0, size.height);
+                }
+            }
+            return result;
+        }
+
+        // Bin the points by row (counting sort), so a band only visits the points that can reach its rows
+        std::vector<int> rowOffsets(size.height + 1, 0);
+        for (size_t i = 0; i < points.size(); i++) {
+            assert(points.v[i] >= 0 && points.v[i] < size.height);
+            rowOffsets[int(points.v[i]) + 1]++;
+        }
+        for (int row = 0; row < size.height; row++) {
+            rowOffsets[row + 1] += rowOffsets[row];
+        }
+        std::vector<int> order(points.size());
+        std::vector<int> next(rowOffsets.begin(), rowOffsets.end() - 1);
+        for (size_t i = 0; i < points.size(); i++) {
+            order[next[int(points.v[i])]++] = int(i);
+        }
+
+        const int bands = std::min(size.height, std::max(1, cv::getNumThreads() * 4));
+        cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range &range) {
+            for (int band = range.start; band < range.end; band++) {
+                auto rowBegin = int(int64_t(size.height) * band / bands);
+                auto rowEnd = int(int64_t(size.height) * (band + 1) / bands);
+
+                // Points up to radius rows outside of the band still cover it
+                auto first = rowOffsets[std::max(rowBegin - radius, 0)];
+                auto last = rowOffsets[std::min(rowEnd + radius, size.height)];
+                for (int j = first; j < last; j++) {
+                    auto i = order[j];
+                    if (points.z[i] > 0) {
+                        splat(result, int(points.u[i]), int(points.v[i]), points.z[i], radius, rowBegin, rowEnd);
+                    }
+                }
+            }
+        });
+        return result;
+    }
+
     std::optional<double> getDepth(const cv::Mat &depthMap, const cv::Rect &bbox) {
-        return common::median<double>(depthMap(bbox), [](auto &val) { return val > 0; });
+        return getDepth(depthMap, bbox, cv::Mat());
     }
 
     std::optional<double> getDepth(const cv::Mat &depthMap, const cv::Rect &bbox, const cv::Mat &mask) {
-        // TODO: avoid copies
-        auto boxed = depthMap(bbox);
-        cv::Mat masked;
-        boxed.copyTo(masked, mask);
-        return common::median<double>(masked, [](auto &val) { return val > 0; });
+        const auto unit = common::depthUnit(depthMap.type());
+        return common::dispatchDepth(depthMap.type(), [&](auto type) -> std::optional<double> {
+            using T = decltype(type);
+            auto depth = common::median<T>(depthMap(bbox), mask, [](const T &val) { return val > 0; });
+            if (!depth) {
+                return {};
+            }
+            return *depth * unit;
+        });
+    }
+
+    std::vector<std::optional<double>> getDepths(const cv::Mat &depthMap, const std::vector<cv::Rect> &boxes,
+                                                 const std::vector<cv::Mat> &masks) {
+        assert(masks.empty() || masks.size() == boxes.size());
+        return common::parallelQueries(boxes.size(), [&](size_t i) {
+            return getDepth(depthMap, boxes[i], masks.empty() ? cv::Mat() : masks[i]);
+        });
     }
 }
\ No newline at end of file
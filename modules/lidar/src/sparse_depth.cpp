@@ -0,0 +1,111 @@
+#include <lidar/sparse_depth.hpp>
+
+#include <common/quantile.hpp>
+
+#include <algorithm>
+
+namespace ivd::lidar {
+
+    namespace {
+        std::optional<double> median(std::vector<float> &values) {
+            if (values.empty()) {
+                return {};
+            }
+            return common::quantile(values, 0.5);
+        }
+    }
+
+    SparseDepthMap::SparseDepthMap(const ProjectedPoints &points, const cv::Size &size, Keep keep) {
+        assign(points, size, keep);
+    }
+
+    void SparseDepthMap::assign(const ProjectedPoints &points, const cv::Size &size, Keep keep) {
+        assert(size.width > 0 && size.height > 0);
+        size_ = size;
+
+        // Count points per row
+        rowOffsets_.assign(size.height + 1, 0);
+        for (size_t i = 0; i < points.size(); i++) {
+            assert(points.u[i] >= 0 && points.u[i] < size.width);
+            assert(points.v[i] >= 0 && points.v[i] < size.height);
+            rowOffsets_[int(points.v[i]) + 1]++;
+        }
+        for (int row = 0; row < size.height; row++) {
+            rowOffsets_[row + 1] += rowOffsets_[row];
+        }
+
+        // Stable counting sort by row, keeps the original point order within a row
+        order_.resize(points.size());
+        next_.assign(rowOffsets_.begin(), rowOffsets_.end() - 1);
+        for (size_t i = 0; i < points.size(); i++) {
+            order_[next_[int(points.v[i])]++] = int(i);
+        }
+
+        // Sort each row by column and keep one point per pixel, compacting in place
+        cols_.resize(points.size());
+        depths_.resize(points.size());
+        int out = 0;
+        for (int row = 0; row < size.height; row++) {
+            auto first = order_.begin() + rowOffsets_[row];
+            auto last = order_.begin() + rowOffsets_[row + 1];
+            std::stable_sort(first, last, [&](int a, int b) { return int(points.u[a]) < int(points.u[b]); });
+
+            rowOffsets_[row] = out;
+            for (auto it = first; it != last; ++it) {
+                auto col = int(points.u[*it]);
+                auto z = points.z[*it];
+                if (z <= 0) {
+                    continue;
+                }
+                if (out > rowOffsets_[row] && cols_[out - 1] == col) {
+                    if (keep == Keep::Last || z < depths_[out - 1]) {
+                        depths_[out - 1] = z;
+                    }
+                } else {
+                    cols_[out] = col;
+                    depths_[out] = z;
+                    out++;
+                }
+            }
+        }
+        rowOffsets_[size.height] = out;
+        cols_.resize(out);
+        depths_.resize(out);
+    }
+
+    std::optional<double> SparseDepthMap::getDepth(const cv::Rect &bbox) const {
+        auto &values = common::quantileScratch<float>();
+        forEach(bbox, [&](int, int, float z) { values.push_back(z); });
+        return median(values);
+    }
+
+    std::optional<double> SparseDepthMap::getDepth(const cv::Rect &bbox, const cv::Mat &mask) const {
+        if (mask.empty()) {
+            return getDepth(bbox);
+        }
+        assert(mask.type() == CV_8U);
+        assert(mask.size() == bbox.size());
+
+        auto &values = common::quantileScratch<float>();
+        forEach(bbox, [&](int col, int row, float z) {
+            if (mask.at<uchar>(row - bbox.y, col - bbox.x)) {
+                values.push_back(z);
+            }
+        });
+        return median(values);
+    }
+
+    std::vector<std::optional<double>> SparseDepthMap::getDepths(const std::vector<cv::Rect> &boxes,
+                                                                 const std::vector<cv::Mat> &masks) const {
+        assert(masks.empty() || masks.size() == boxes.size());
+        return common::parallelQueries(boxes.size(), [&](size_t i) {
+            return getDepth(boxes[i], masks.empty() ? cv::Mat() : masks[i]);
+        });
+    }
+
+    cv::Mat SparseDepthMap::toDense() const {
+        cv::Mat result(size_, CV_64F, cv::Scalar(0));
+        forEach({{}, size_}, [&](int col, int row, float z) { result.at<double>(row, col) = z; });
+        return result;
+    }
+}
@@ -1,5 +1,7 @@
 #include <lidar/visualize.hpp>
 
+#include <common/depth_format.hpp>
+
 #include <colormap/colormap.hpp>
 
 namespace ivd::lidar {
@@ -24,37 +26,99 @@ namespace ivd::lidar {
         }
     }
 
-    void visualizeLidarDepthForBBox(cv::Mat &image, const cv::Mat &depthMap, const cv::Rect &bbox,
-                                    const cv::Mat &mask,
-                                    const std::string &palette, double maxDistance) {
+    namespace {
+        // Cross shaped splat, only the rows in [rowBegin, rowEnd)
+        inline void splat(cv::Mat &image, int u, int v, const cv::Vec3b &color, int rowBegin, int rowEnd) {
+            if (v >= rowBegin && v < rowEnd) {
+                auto *row = image.ptr<cv::Vec3b>(v);
+                for (int col = std::max(u - 1, 0); col <= std::min(u + 1, image.cols - 1); col++) {
+                    row[col] = color;
+                }
+            }
+            if (v - 1 >= rowBegin && v - 1 < rowEnd) {
+                image.ptr<cv::Vec3b>(v - 1)[u] = color;
+            }
+            if (v + 1 >= rowBegin && v + 1 < rowEnd) {
+                image.ptr<cv::Vec3b>(v + 1)[u] = color;
+            }
+        }
 
-        // Pretty colors
-        auto pal = colormap::palettes.at(palette).rescale(0, maxDistance);
+        // Splits the image in row bands, fn(rowBegin, rowEnd) only writes its own rows
+        template<class Fn>
+        void forRowBands(const cv::Mat &image, Fn &&fn) {
+            const int bands = std::min(image.rows, std::max(1, cv::getNumThreads() * 2));
+            cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range &range) {
+                for (int band = range.start; band < range.end; band++) {
+                    fn(int(int64_t(image.rows) * band / bands), int(int64_t(image.rows) * (band + 1) / bands));
+                }
+            });
+        }
+    }
 
-        // Copy lidar distances within bbox and optional mask
-        cv::Mat masked;
-        auto boxed = depthMap(bbox);
-        if (mask.empty()) {
-            masked = boxed;
-        } else {
-            boxed.copyTo(masked, mask);
+    ColorLut::ColorLut(const std::string &palette, double maxDistance) : scale_(255 / maxDistance) {
+        assert(maxDistance > 0);
+        auto pal = colormap::palettes.at(palette).rescale(0, maxDistance);
+        for (int i = 0; i < 256; i++) {
+            auto color = pal(i / scale_);
+            colors_[i] = cv::Vec3b(color.getBlue().getValue(), color.getGreen().getValue(),
+                                   color.getRed().getValue());
         }
+    }
 
-        // For all points > 0 draw a circle (upscaling with the BBox)
-        for (size_t r = 0; r < masked.rows; r++) {
-            for (size_t c = 0; c < masked.cols; c++) {
-                auto z = masked.at<double>(r, c);
-                if (z > 0) {
-                    auto color = pal(z);
-
-                    cv::circle(image, cv::Point(bbox.x + c, bbox.y + r), 1,
-                               cv::Scalar(color.getBlue().getValue(), color.getGreen().getValue(),
-                                          color.getRed().getValue()),
-                               -1);
+    void renderLidarPoints(cv::Mat &image, const ProjectedPoints &points, const std::string &palette,
+                           double maxDistance) {
+        assert(image.type() == CV_8UC3);
+        ColorLut lut(palette, maxDistance);
+
+        forRowBands(image, [&](int rowBegin, int rowEnd) {
+            for (size_t i = 0; i < points.size(); i++) {
+                auto u = int(points.u[i]);
+                auto v = int(points.v[i]);
+                if (v + 1 >= rowBegin && v - 1 < rowEnd && u >= 0 && u < image.cols) {
+                    splat(image, u, v, lut(points.z[i]), rowBegin, rowEnd);
                 }
             }
+        });
+    }
+
+    void visualizeLidarDepthForBBox(cv::Mat &image, const cv::Mat &depthMap, const cv::Rect &bbox,
+                                    const cv::Mat &mask,
+                                    const std::string &palette, double maxDistance) {
+        assert(image.type() == CV_8UC3);
+        assert(depthMap.size() == image.size());
+        assert(mask.empty() || (mask.type() == CV_8U && mask.size() == bbox.size()));
 
+        // Only the part of the box inside the image
+        const auto box = bbox & cv::Rect({}, depthMap.size());
+        if (box.empty()) {
+            return;
         }
+        const cv::Mat boxMask = mask.empty() ? mask : mask(box - bbox.tl());
+
+        ColorLut lut(palette, maxDistance);
+        const auto unit = common::depthUnit(depthMap.type());
+
+        // For all points > 0 (within the optional mask) draw a splat, the box rows (+1 for the splats) in bands
+        auto region = cv::Rect(box.x, box.y - 1, box.width, box.height + 2) & cv::Rect({}, image.size());
+        auto target = image(cv::Rect(0, region.y, image.cols, region.height));
+        forRowBands(target, [&](int rowBegin, int rowEnd) {
+            // Rows of the box that can reach the band
+            auto first = std::max(rowBegin + region.y - 1, box.y);
+            auto last = std::min(rowEnd + region.y + 1, box.y + box.height);
+            common::dispatchDepth(depthMap.type(), [&](auto type) {
+                using T = decltype(type);
+                for (int row = first; row < last; row++) {
+                    auto *depths = depthMap.ptr<T>(row);
+                    auto *m = boxMask.empty() ? nullptr : boxMask.ptr<uchar>(row - box.y);
+                    for (int c = 0; c < box.width; c++) {
+                        double z = depths[box.x + c] * unit;
+                        if (z > 0 && (!m || m[c])) {
+                            splat(target, box.x + c, row - region.y, lut(z), rowBegin, rowEnd);
+                        }
+                    }
+                }
+            });
+        });
     }
 
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "ml_model.hpp"
+#include "nms.hpp"
+#include "profiling.hpp"
 
 #include <opencv2/opencv.hpp>
 
@@ -34,18 +36,45 @@ namespace ivd::ml {
         struct PredictionOptions {
             float scoreThreshold{0.45};
             float iouThreshold{0.50};
+            // Number of highest scoring candidates that enter NMS (0 == all)
+            size_t topK{30000};
+            // Suppress overlapping boxes of different classes
+            bool classAgnostic{true};
+        };
+
+        struct TilingOptions {
+            // Grid of overlapping crops the image is split into
+            int columns{3};
+            int rows{1};
+            // Fraction of a tile that overlaps with its neighbour
+            float overlap{0.2};
         };
 
     public:
-        explicit DetectMLModel(std::filesystem::path model);
+        explicit DetectMLModel(std::filesystem::path model, const MLRuntime::SessionConfig &sessionConfig = {});
 
         ~DetectMLModel() override = default;
 
         std::vector<Detection> predict(const cv::Mat& image, PredictionOptions options = {0.25, 0.45});
 
+        // Runs the model on overlapping crops of the image and merges the results in one NMS pass
+        std::vector<Detection> predictTiled(const cv::Mat &image, TilingOptions tiling = {},
+                                            PredictionOptions options = {0.25, 0.45});
+
+        static std::vector<cv::Rect> tiles(const cv::Size &imageSize, const TilingOptions &tiling);
+
         Size<int64_t> inputSize() const {
             return inputSize_;
         };
+
+        // Per stage latencies and counters, only populated with ML_PROFILING
+        const Profiler &profiler() const {
+            return profiler_;
+        }
+
+        void resetProfiler() {
+            profiler_.reset();
+        }
     private:
         struct PreprocessedImage {
             cv::Mat blob;
@@ -59,12 +88,37 @@ namespace ivd::ml {
             } padding;
             cv::Size originalSize;
         };
+        struct Inference {
+            PreprocessedImage preprocessed;
+            std::vector<Ort::Value> outputs;
+            // Location of the inferred region in the full image
+            cv::Point offset;
+        };
+
+        struct Candidates {
+            // Boxes in full image coordinates
+            BoxCandidates boxes;
+            // Integer boxes relative to the inferred region (mask roi)
+            std::vector<cv::Rect> rects;
+            std::vector<std::vector<float>> masks;
+            std::vector<size_t> inference;
+        };
+
         PreprocessedImage preprocess(const cv::Mat& image) const;
 
+        Inference infer(const cv::Mat &image, cv::Point offset = {});
+
+        void decode(Inference &inference, size_t inferenceIdx, const PredictionOptions &options,
+                    Candidates &candidates) const;
+
+        std::vector<Detection> finalize(std::vector<Inference> &inferences, const Candidates &candidates,
+                                        const PredictionOptions &options) const;
+
         cv::Mat processMask(cv::Mat protos, const cv::Rect &box, const std::vector<float> &mask,
                             const PreprocessedImage &) const;
     private:
         Size<int64_t> inputSize_{};
+        mutable Profiler profiler_;
     };
 
 }
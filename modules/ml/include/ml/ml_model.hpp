@@ -14,7 +14,7 @@ namespace ivd::ml {
 
     class MLModel {
     public:
-        explicit MLModel(std::filesystem::path modelPath);
+        explicit MLModel(std::filesystem::path modelPath, const MLRuntime::SessionConfig &sessionConfig = {});
 
         virtual ~MLModel() = default;
 
@@ -34,6 +34,9 @@ namespace ivd::ml {
             return outputNames_;
         }
 
+        // Stops the ONNX Runtime profiler (see MLRuntime::SessionConfig) and returns the trace file
+        std::filesystem::path endProfiling();
+
     protected:
         std::filesystem::path modelPath_;
         std::shared_ptr<MLRuntime> mlRuntime_;
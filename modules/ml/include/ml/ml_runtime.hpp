@@ -3,21 +3,32 @@
 #include <onnxruntime_cxx_api.h>
 
 #include <memory>
+#include <mutex>
 #include <filesystem>
 
 namespace ivd::ml {
     class MLRuntime {
+    public:
+        struct SessionConfig {
+            // Share pre-packed weights between sessions of the same model (see ModelPool)
+            bool sharePrepackedWeights{false};
+            // Enables the ONNX Runtime profiler, writing a trace file with this prefix
+            std::filesystem::path profilingPrefix{};
+        };
+
     public:
         MLRuntime();
         static std::shared_ptr<MLRuntime> Get();
 
         std::vector<std::string> availableProviders() const;
 
-        Ort::Session createSession(const std::filesystem::path& model) const;
+        Ort::Session createSession(const std::filesystem::path& model, const SessionConfig &config = {}) const;
 
     private:
+        static std::mutex instanceMutex_;
         static std::weak_ptr<MLRuntime> instance_;
 
         Ort::Env env_;
+        Ort::PrepackedWeightsContainer prepackedWeights_;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <ml/ml_runtime.hpp>
+
+#include <cassert>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace ivd::ml {
+
+    /**
+     * Bounded pool of models that can be checked out concurrently, eg one per camera stream.
+     * Models are created lazily up to the capacity. When all of them are checked out,
+     * acquire() blocks until a lease is returned. The pool must outlive its leases.
+     */
+    template<class Model>
+    class ModelPool {
+    public:
+        using Factory = std::function<std::unique_ptr<Model>()>;
+
+        class Lease {
+        public:
+            Lease(Lease &&other) noexcept : pool_(other.pool_), model_(std::move(other.model_)) {
+                other.pool_ = nullptr;
+            }
+
+            Lease &operator=(Lease &&other) noexcept {
+                if (this != &other) {
+                    release();
+                    pool_ = other.pool_;
+                    model_ = std::move(other.model_);
+                    other.pool_ = nullptr;
+                }
+                return *this;
+            }
+
+            Lease(const Lease &) = delete;
+
+            Lease &operator=(const Lease &) = delete;
+
+            ~Lease() {
+                release();
+            }
+
+            Model &operator*() const {
+                return *model_;
+            }
+
+            Model *operator->() const {
+                return model_.get();
+            }
+
+        private:
+            friend class ModelPool;
+
+            Lease(ModelPool *pool, std::unique_ptr<Model> model) : pool_(pool), model_(std::move(model)) {
+            }
+
+            void release() {
+                if (pool_ && model_) {
+                    pool_->giveBack(std::move(model_));
+                }
+                pool_ = nullptr;
+            }
+
+        private:
+            ModelPool *pool_;
+            std::unique_ptr<Model> model_;
+        };
+
+    public:
+        ModelPool(size_t capacity, Factory factory) : capacity_(capacity), factory_(std::move(factory)) {
+            assert(capacity_ > 0);
+            idle_.reserve(capacity_);
+        }
+
+        ModelPool(const ModelPool &) = delete;
+
+        ModelPool &operator=(const ModelPool &) = delete;
+
+        Lease acquire() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            available_.wait(lock, [&] { return !idle_.empty() || created_ < capacity_; });
+            return take(lock);
+        }
+
+        std::optional<Lease> tryAcquire() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (idle_.empty() && created_ >= capacity_) {
+                return {};
+            }
+            return take(lock);
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+
+        // Number of models created so far
+        size_t size() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return created_;
+        }
+
+        // Number of models created and not checked out
+        size_t idle() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return idle_.size();
+        }
+
+    private:
+        Lease take(std::unique_lock<std::mutex> &lock) {
+            if (!idle_.empty()) {
+                auto model = std::move(idle_.back());
+                idle_.pop_back();
+                return {this, std::move(model)};
+            }
+
+            // Reserve a slot and create the model outside the lock, loading a model is slow
+            created_++;
+            lock.unlock();
+            try {
+                return {this, factory_()};
+            } catch (...) {
+                lock.lock();
+                created_--;
+                lock.unlock();
+                available_.notify_one();
+                throw;
+            }
+        }
+
+        void giveBack(std::unique_ptr<Model> model) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                idle_.push_back(std::move(model));
+            }
+            available_.notify_one();
+        }
+
+    private:
+        const size_t capacity_;
+        Factory factory_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable available_;
+        std::vector<std::unique_ptr<Model>> idle_;
+        size_t created_{0};
+    };
+
+    /**
+     * Factory for models that share their pre-packed weights through the MLRuntime
+     */
+    template<class Model>
+    typename ModelPool<Model>::Factory modelFactory(std::filesystem::path model,
+                                                     MLRuntime::SessionConfig sessionConfig = {true}) {
+        return [model = std::move(model), sessionConfig]() {
+            return std::make_unique<Model>(model, sessionConfig);
+        };
+    }
+}
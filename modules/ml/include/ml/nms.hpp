@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace ivd::ml {
+
+    // Candidate boxes in a structure of arrays layout (top left / bottom right corners)
+    struct BoxCandidates {
+        std::vector<float> x1;
+        std::vector<float> y1;
+        std::vector<float> x2;
+        std::vector<float> y2;
+        std::vector<float> scores;
+        std::vector<int> classIds;
+
+        size_t size() const {
+            return scores.size();
+        }
+
+        bool empty() const {
+            return scores.empty();
+        }
+
+        void reserve(size_t capacity);
+
+        void clear();
+
+        void push_back(float left, float top, float right, float bottom, float score, int classId);
+    };
+
+    struct NMSOptions {
+        float scoreThreshold{0.25};
+        float iouThreshold{0.45};
+        // Only the topK highest scoring candidates are considered (0 == all)
+        size_t topK{30000};
+        // Suppress overlapping boxes regardless of their class
+        bool classAgnostic{true};
+    };
+
+    /**
+     * Greedy non maximum suppression. Classes are suppressed independently (and in parallel)
+     * unless options.classAgnostic is set.
+     *
+     * @return indices of the kept candidates, ordered by descending score
+     */
+    std::vector<int> nms(const BoxCandidates &candidates, const NMSOptions &options);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ivd::ml {
+
+    /**
+     * Latency samples in milliseconds. Percentiles are computed over the last `capacity` samples.
+     */
+    class LatencyHistogram {
+    public:
+        explicit LatencyHistogram(size_t capacity = 4096);
+
+        void record(double ms);
+
+        // Total number of samples recorded
+        size_t count() const {
+            return count_;
+        }
+
+        double percentile(double p) const;
+
+        double mean() const;
+
+        double max() const {
+            return max_;
+        }
+
+        void reset();
+
+    private:
+        std::vector<double> samples_;
+        size_t capacity_;
+        size_t next_{0};
+        size_t count_{0};
+        double sum_{0};
+        double max_{0};
+    };
+
+    class Profiler {
+    public:
+        enum class Stage {
+            Preprocess,
+            Inference,
+            Decode,
+            NMS,
+            Mask,
+            Total,
+        };
+        static constexpr size_t stageCount = 6;
+
+        enum class Counter {
+            Frames,
+            Candidates,
+            Detections,
+        };
+        static constexpr size_t counterCount = 3;
+
+        struct Summary {
+            size_t count;
+            double mean;
+            double p50;
+            double p95;
+            double p99;
+            double max;
+        };
+
+        class Scope {
+        public:
+            Scope(Profiler &profiler, Stage stage)
+                    : profiler_(profiler), stage_(stage), start_(std::chrono::steady_clock::now()) {
+            }
+
+            ~Scope() {
+                auto end = std::chrono::steady_clock::now();
+                profiler_.record(stage_, std::chrono::duration<double, std::milli>(end - start_).count());
+            }
+
+            Scope(const Scope &) = delete;
+
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            Profiler &profiler_;
+            Stage stage_;
+            std::chrono::steady_clock::time_point start_;
+        };
+
+    public:
+        // Compiled in with the ML_PROFILING CMake option
+        static constexpr bool enabled() {
+#ifdef ML_PROFILING
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        static const char *name(Stage stage);
+
+        static const char *name(Counter counter);
+
+        void record(Stage stage, double ms) {
+            stages_[size_t(stage)].record(ms);
+        }
+
+        void add(Counter counter, size_t value) {
+            counters_[size_t(counter)] += value;
+        }
+
+        const LatencyHistogram &histogram(Stage stage) const {
+            return stages_[size_t(stage)];
+        }
+
+        size_t total(Counter counter) const {
+            return counters_[size_t(counter)];
+        }
+
+        Summary summary(Stage stage) const;
+
+        std::string report() const;
+
+        void reset();
+
+    private:
+        std::array<LatencyHistogram, stageCount> stages_;
+        std::array<size_t, counterCount> counters_{};
+    };
+}
+
+#ifdef ML_PROFILING
+#define ML_PROFILE_CONCAT_INNER(a, b) a##b
+#define ML_PROFILE_CONCAT(a, b) ML_PROFILE_CONCAT_INNER(a, b)
+#define ML_PROFILE_SCOPE(profiler, stage) \
+    ::ivd::ml::Profiler::Scope ML_PROFILE_CONCAT(mlProfileScope, __LINE__)(profiler, ::ivd::ml::Profiler::Stage::stage)
+#define ML_PROFILE_COUNT(profiler, counter, value) (profiler).add(::ivd::ml::Profiler::Counter::counter, value)
+#else
+#define ML_PROFILE_SCOPE(profiler, stage)
+#define ML_PROFILE_COUNT(profiler, counter, value)
+#endif
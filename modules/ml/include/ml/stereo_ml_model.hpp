@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ml_model.hpp"
+
+#include <opencv2/opencv.hpp>
+
+#include <filesystem>
+
+namespace ivd::ml {
+
+    /**
+     * Learned stereo matching, an alternative to SGBM with the same output: disparity (CV_32F, px) of the
+     * left image at its full resolution.
+     *
+     * The model either takes the left and right images as two inputs, or as one input with both stacked along
+     * the channels (left first), NCHW with 1 (gray) or 3 channels each. Dynamic height and width run at the
+     * image size rounded down to a multiple of 32. The first output is the disparity at input resolution,
+     * [1, H, W], [1, 1, H, W] or [1, C, H, W] of which the first channel is used. See
+     * models/stereo/stereo_export_model.py for exporting one to models/stereo/stereo.onnx.
+     *
+     * Color images are BGR, as cv::imread and the KITTI parser load them. Like DetectMLModel, they are swapped
+     * to the RGB order the exported networks take (InputOptions::swapRB).
+     */
+    class StereoMLModel : public MLModel {
+    public:
+        struct InputOptions {
+            // Blob = (image - mean) * scale
+            double scale{1 / 255.0};
+            cv::Scalar mean{0, 0, 0};
+            // BGR images to an RGB network
+            bool swapRB{true};
+        };
+
+    public:
+        explicit StereoMLModel(std::filesystem::path model, const MLRuntime::SessionConfig &sessionConfig = {},
+                               const InputOptions &inputOptions = {});
+
+        ~StereoMLModel() override = default;
+
+        cv::Mat predict(const cv::Mat &left, const cv::Mat &right);
+
+        void predict(const cv::Mat &left, const cv::Mat &right, cv::Mat &disparity);
+
+        // Resolution the model runs at for images of size
+        cv::Size inputSize(const cv::Size &imageSize) const;
+
+        int channels() const {
+            return channels_;
+        }
+
+    private:
+        cv::Mat blob(const cv::Mat &image, const cv::Size &size) const;
+
+    private:
+        InputOptions inputOptions_;
+        // Left and right in one input
+        bool stacked_{false};
+        int channels_{3};
+        // <= 0 == dynamic
+        int64_t width_{0};
+        int64_t height_{0};
+    };
+}
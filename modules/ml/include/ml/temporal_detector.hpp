@@ -0,0 +1,79 @@
+#pragma once
+
+#include <ml/detect_ml_model.hpp>
+
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+
+namespace ivd::ml {
+
+    /**
+     * Skips inference on frames that barely changed since the last inferred (key) frame and
+     * propagates the key frame detections with the estimated global image shift instead.
+     */
+    class TemporalDetector {
+    public:
+        struct Options {
+            // Mean absolute difference (0-255) of the shift compensated, downsampled frames below which
+            // inference is skipped
+            double changeThreshold{4.0};
+            // Infer at least every N + 1 frames
+            uint32_t maxSkippedFrames{5};
+            // Width of the downsampled frame used for the change gate
+            int thumbnailWidth{160};
+            // Also infer skipped frames to measure the drift of the propagated detections (slow)
+            bool measureDrift{false};
+        };
+
+        struct Stats {
+            size_t frames{0};
+            size_t inferred{0};
+            size_t skipped{0};
+
+            // Drift against full inference, only with Options::measureDrift
+            size_t driftSamples{0};
+            double driftIoUSum{0};
+            // Detections of full inference without a propagated match (IoU < 0.5)
+            size_t missed{0};
+            // Propagated detections without a full inference match
+            size_t spurious{0};
+
+            double meanDriftIoU() const {
+                return driftSamples > 0 ? driftIoUSum / driftSamples : 0;
+            }
+        };
+
+    public:
+        explicit TemporalDetector(DetectMLModel &model, Options options = {});
+
+        std::vector<Detection> predict(const cv::Mat &image,
+                                       DetectMLModel::PredictionOptions predictionOptions = {0.25, 0.45});
+
+        // Forget the key frame, the next frame is always inferred
+        void reset();
+
+        bool lastFrameInferred() const {
+            return skipped_ == 0;
+        }
+
+        const Stats &stats() const {
+            return stats_;
+        }
+
+    private:
+        cv::Mat thumbnail(const cv::Mat &image);
+
+        void measureDrift(const std::vector<Detection> &propagated, const std::vector<Detection> &inferred);
+
+    private:
+        DetectMLModel &model_;
+        Options options_;
+        Stats stats_;
+
+        cv::Mat keyThumbnail_;
+        cv::Mat window_;
+        std::vector<Detection> keyDetections_;
+        uint32_t skipped_{0};
+    };
+}
@@ -1,9 +1,11 @@
 #include <ml/detect_ml_model.hpp>
+#include <ml/nms.hpp>
 #include <ml/yolo/yolo_classes.hpp>
 
 namespace ivd::ml {
 
-    DetectMLModel::DetectMLModel(std::filesystem::path model) : MLModel(std::move(model)) {
+    DetectMLModel::DetectMLModel(std::filesystem::path model, const MLRuntime::SessionConfig &sessionConfig)
+            : MLModel(std::move(model), sessionConfig) {
         auto inputNode = std::find_if(inputNodes().begin(), inputNodes().end(), [](const auto &node) {
             // TODO: YOLO specific
             return node.name == "images";
@@ -12,14 +14,72 @@ namespace ivd::ml {
         assert((*inputNode).dimensions.size() == 4);
         assert((*inputNode).dimensions[0] == 1); // 1 image
         assert((*inputNode).dimensions[1] == 3); // 3 channels
-        inputSize_ = {(*inputNode).dimensions[2], (*inputNode).dimensions[3]}; // 640x640
+        // NCHW, eg 640x640 or a rectangular export like 640x192
+        inputSize_ = {(*inputNode).dimensions[3], (*inputNode).dimensions[2]};
     }
 
     std::vector<Detection> DetectMLModel::predict(const cv::Mat& image, PredictionOptions options) {
-        auto inputShape = inputNodes()[0].dimensions;
+        ML_PROFILE_SCOPE(profiler_, Total);
+        ML_PROFILE_COUNT(profiler_, Frames, 1);
+        std::vector<Inference> inferences;
+        inferences.push_back(infer(image));
 
-        auto preprocessedImage = preprocess(image);
+        Candidates candidates;
+        decode(inferences[0], 0, options, candidates);
 
+        return finalize(inferences, candidates, options);
+    }
+
+    std::vector<Detection> DetectMLModel::predictTiled(const cv::Mat &image, TilingOptions tiling,
+                                                       PredictionOptions options) {
+        ML_PROFILE_SCOPE(profiler_, Total);
+        ML_PROFILE_COUNT(profiler_, Frames, 1);
+        std::vector<Inference> inferences;
+        Candidates candidates;
+        for (auto &tile: tiles(image.size(), tiling)) {
+            inferences.push_back(infer(image(tile), tile.tl()));
+            decode(inferences.back(), inferences.size() - 1, options, candidates);
+        }
+
+        // Merged NMS takes care of duplicates in the overlapping areas
+        return finalize(inferences, candidates, options);
+    }
+
+    std::vector<cv::Rect> DetectMLModel::tiles(const cv::Size &imageSize, const TilingOptions &tiling) {
+        assert(tiling.columns > 0);
+        assert(tiling.rows > 0);
+        assert(tiling.overlap >= 0 && tiling.overlap < 1);
+
+        // n tiles of size t overlapping by o: n * t - (n - 1) * o * t = image size
+        auto span = [&](int size, int count) {
+            auto tileSize = int(std::ceil(size / (count - (count - 1) * tiling.overlap)));
+            tileSize = std::min(tileSize, size);
+            auto stride = count > 1 ? (size - tileSize) / double(count - 1) : 0.0;
+            std::vector<std::pair<int, int>> result;
+            for (int i = 0; i < count; i++) {
+                result.emplace_back(int(std::round(i * stride)), tileSize);
+            }
+            return result;
+        };
+
+        std::vector<cv::Rect> result;
+        for (auto &[y, height]: span(imageSize.height, tiling.rows)) {
+            for (auto &[x, width]: span(imageSize.width, tiling.columns)) {
+                result.emplace_back(x, y, width, height);
+            }
+        }
+        return result;
+    }
+
+    DetectMLModel::Inference DetectMLModel::infer(const cv::Mat &image, cv::Point offset) {
+        std::vector<int64_t> inputShape{1, 3, inputSize_.height, inputSize_.width};
+
+        auto preprocessedImage = [&]() {
+            ML_PROFILE_SCOPE(profiler_, Preprocess);
+            return preprocess(image);
+        }();
+
+        ML_PROFILE_SCOPE(profiler_, Inference);
         auto inputTensor = Ort::Value::CreateTensor<float>(
                 Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault),
                 (float *) preprocessedImage.blob.data, preprocessedImage.blob.total(), inputShape.data(),
@@ -28,6 +88,16 @@ namespace ivd::ml {
         auto outputs = session_.Run(Ort::RunOptions{nullptr},
                                     inputNames_.data(), &inputTensor, inputNames().size(), outputNames_.data(),
                                     outputNames_.size());
+
+        return {std::move(preprocessedImage), std::move(outputs), offset};
+    }
+
+    void DetectMLModel::decode(Inference &inference, size_t inferenceIdx, const PredictionOptions &options,
+                               Candidates &candidates) const {
+        ML_PROFILE_SCOPE(profiler_, Decode);
+        auto &outputs = inference.outputs;
+        auto &preprocessedImage = inference.preprocessed;
+        const auto imageSize = preprocessedImage.originalSize;
         bool segmentation = outputs.size() > 1;
 
         auto output0DataShape = outputs[0].GetTensorTypeAndShapeInfo().GetShape();
@@ -35,13 +105,9 @@ namespace ivd::ml {
                                   outputs[0].GetTensorMutableData<float>()).t();
 
         auto *data = (float *) output0.data;
-        std::vector<int> classIds;
-        std::vector<float> confidences;
-        std::vector<cv::Rect> boxes;
-        std::vector<std::vector<float>> masks;
+        [[maybe_unused]] const auto firstCandidate = candidates.rects.size();
 
         const auto rowWidth = output0.cols;
-        const auto boxWidth = 4;
         // Output tensor layout:
         // - output0: [x, y, h, w, class_1, …, class_80]
         // - output1: [x, y, h, w, ]
@@ -56,11 +122,8 @@ namespace ivd::ml {
             cv::minMaxLoc(scores, nullptr, &maxClassScore, nullptr, &classId);
 
             if (maxClassScore > options.scoreThreshold) {
-                confidences.push_back(maxClassScore);
-                classIds.push_back(classId.x);
-
                 if (segmentation) {
-                    masks.push_back(std::vector<float>(data + 4 + yolo::class_names.size(), data + rowWidth));
+                    candidates.masks.push_back(std::vector<float>(data + 4 + yolo::class_names.size(), data + rowWidth));
                 }
 
                 float x = data[0];
@@ -69,41 +132,60 @@ namespace ivd::ml {
                 float h = data[3];
 
                 // Scale boxes and crop to input image size
-                int left = std::max(0, int(preprocessedImage.scale.width * (x - 0.5 * w - preprocessedImage.padding.left)));
-                int top = std::max(0, int(preprocessedImage.scale.width * (y - 0.5 * h - preprocessedImage.padding.top)));
-                int width = std::min(image.size().width - left, int(w * preprocessedImage.scale.x));
-                int height = std::min(image.size().height - top, int(h * preprocessedImage.scale.y));
-
-                // TODO: top left, bottom right instead
-
-                boxes.emplace_back(left, top, width, height);
+                double x1 = std::max(0.0, preprocessedImage.scale.x * (x - 0.5 * w - preprocessedImage.padding.left));
+                double y1 = std::max(0.0, preprocessedImage.scale.y * (y - 0.5 * h - preprocessedImage.padding.top));
+                double x2 = std::min(double(imageSize.width), x1 + w * preprocessedImage.scale.x);
+                double y2 = std::min(double(imageSize.height), y1 + h * preprocessedImage.scale.y);
+
+                // NMS on the float boxes (full image), detections keep the integer boxes (mask roi)
+                candidates.boxes.push_back(float(x1 + inference.offset.x), float(y1 + inference.offset.y),
+                                           float(x2 + inference.offset.x), float(y2 + inference.offset.y),
+                                           float(maxClassScore), classId.x);
+
+                int left = int(x1);
+                int top = int(y1);
+                int width = std::min(imageSize.width - left, int(w * preprocessedImage.scale.x));
+                int height = std::min(imageSize.height - top, int(h * preprocessedImage.scale.y));
+                candidates.rects.emplace_back(left, top, width, height);
+                candidates.inference.push_back(inferenceIdx);
             }
             data += rowWidth;
         }
+        ML_PROFILE_COUNT(profiler_, Candidates, candidates.rects.size() - firstCandidate);
+    }
 
-        std::vector<int> nmsResult;
-        cv::dnn::NMSBoxes(boxes, confidences, options.scoreThreshold, options.iouThreshold, nmsResult);
+    std::vector<Detection> DetectMLModel::finalize(std::vector<Inference> &inferences, const Candidates &candidates,
+                                                   const PredictionOptions &options) const {
+        auto nmsResult = [&]() {
+            ML_PROFILE_SCOPE(profiler_, NMS);
+            return nms(candidates.boxes, {options.scoreThreshold, options.iouThreshold, options.topK,
+                                          options.classAgnostic});
+        }();
+        ML_PROFILE_COUNT(profiler_, Detections, nmsResult.size());
 
         std::vector<Detection> detections{};
         for (int idx: nmsResult) {
             Detection result;
-            result.classIndex = classIds[idx];
-            result.confidence = confidences[idx];
+            result.classIndex = candidates.boxes.classIds[idx];
+            result.confidence = candidates.boxes.scores[idx];
 
             result.className = yolo::class_names[result.classIndex];
-            result.bbox = boxes[idx];
+            result.bbox = candidates.rects[idx] + inferences[candidates.inference[idx]].offset;
             detections.push_back(result);
         }
 
-        if (segmentation) {
-            auto output1DataShape = outputs[1].GetTensorTypeAndShapeInfo().GetShape();
-            // Single image, skip first dimension (1)
-            std::vector<int> maskDimensions{(int) output1DataShape[1], (int) output1DataShape[2],
-                                            (int) output1DataShape[3]};
-            auto protos = cv::Mat(maskDimensions, CV_32F, outputs[1].GetTensorMutableData<float>());
+        if (!candidates.masks.empty()) {
+            ML_PROFILE_SCOPE(profiler_, Mask);
             for (size_t i = 0; i < nmsResult.size(); i++) {
                 auto idx = nmsResult[i];
-                detections[i].mask = processMask(protos, boxes[idx], masks[idx], preprocessedImage);
+                auto &inference = inferences[candidates.inference[idx]];
+                auto output1DataShape = inference.outputs[1].GetTensorTypeAndShapeInfo().GetShape();
+                // Single image, skip first dimension (1)
+                std::vector<int> maskDimensions{(int) output1DataShape[1], (int) output1DataShape[2],
+                                                (int) output1DataShape[3]};
+                auto protos = cv::Mat(maskDimensions, CV_32F, inference.outputs[1].GetTensorMutableData<float>());
+                detections[i].mask = processMask(protos, candidates.rects[idx], candidates.masks[idx],
+                                                 inference.preprocessed);
             }
         }
 
@@ -115,13 +197,15 @@ namespace ivd::ml {
         // Ensure size matches, letterbox if needed
         auto imageSize = inputImage.size();
         cv::Size newSize(inputSize_.width, inputSize_.height);
-        auto r = std::min(newSize.width / double(imageSize.width), newSize.height / double(imageSize.width));
+        auto r = std::min(newSize.width / double(imageSize.width), newSize.height / double(imageSize.height));
 
         cv::Mat image;
         cv::Size sizeUnpadded{int(round(imageSize.width * r)), int(round(imageSize.height * r))};
         cv::Size_<double> padding = {(newSize.width - sizeUnpadded.width) / 2.0, (newSize.height - sizeUnpadded.height) / 2.0};
         if (imageSize != sizeUnpadded) {
             cv::resize(inputImage, image, sizeUnpadded);
+        } else {
+            image = inputImage;
         }
 
         int top = int(round(padding.height - 0.1));
@@ -129,7 +213,8 @@ namespace ivd::ml {
         int left = int(round(padding.width - 0.1));
         int right = int(round(padding.width + 0.1));
 
-        cv::copyMakeBorder(image, image, top, bottom, left, right, cv::BORDER_CONSTANT, cv::Scalar(114, 114, 114));
+        cv::copyMakeBorder(image, image, top, bottom, left, right, cv::BORDER_CONSTANT | cv::BORDER_ISOLATED,
+                           cv::Scalar(114, 114, 114));
 
         return {
                 cv::dnn::blobFromImage(image, 1 / 255.0, cv::Size(inputSize_.width, inputSize_.height),
@@ -151,10 +236,10 @@ namespace ivd::ml {
         cv::Mat mask = cv::Mat(1, c, CV_32F, (void *) maskIn.data()) *
                        cv::Mat(std::vector<int>{c, mw * mh}, protos.type(), protos.ptr<float>(0));
         // Reshape to 160x160
-        mask = cv::Mat(mw, mh, mask.type(), mask.ptr<float>(0));
+        mask = cv::Mat(mh, mw, mask.type(), mask.ptr<float>(0));
 
         // tl br of mask
-        auto scaleW = mh / double(inputSize_.width);
+        auto scaleW = mw / double(inputSize_.width);
         auto scaleH = mh / double(inputSize_.height);
         cv::Rect roi(
                 round(preprocessedImage.padding.left * scaleW - 0.1),
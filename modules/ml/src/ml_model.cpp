@@ -5,9 +5,10 @@
 #include <numeric>
 
 namespace ivd::ml {
-    MLModel::MLModel(std::filesystem::path modelPath) : modelPath_(std::move(modelPath)), mlRuntime_(MLRuntime::Get()) {
+    MLModel::MLModel(std::filesystem::path modelPath, const MLRuntime::SessionConfig &sessionConfig)
+            : modelPath_(std::move(modelPath)), mlRuntime_(MLRuntime::Get()) {
         assert(mlRuntime_);
-        session_ = mlRuntime_->createSession(modelPath_);
+        session_ = mlRuntime_->createSession(modelPath_, sessionConfig);
 
         // Register inputs and outputs
         Ort::AllocatorWithDefaultOptions allocator;
@@ -48,4 +49,9 @@ namespace ivd::ml {
         std::cout << "\n";
 #endif
     }
+
+    std::filesystem::path MLModel::endProfiling() {
+        Ort::AllocatorWithDefaultOptions allocator;
+        return session_.EndProfilingAllocated(allocator).get();
+    }
 }
\ No newline at end of file
@@ -5,9 +5,11 @@
 
 namespace ivd::ml {
 
+    std::mutex MLRuntime::instanceMutex_;
     std::weak_ptr<MLRuntime> MLRuntime::instance_;
 
     std::shared_ptr<MLRuntime> MLRuntime::Get() {
+        std::lock_guard<std::mutex> lock(instanceMutex_);
         if (auto mlRuntime = instance_.lock()) {
             return mlRuntime;
         } else {
@@ -24,17 +26,24 @@ namespace ivd::ml {
         return Ort::GetAvailableProviders();
     }
 
-    Ort::Session MLRuntime::createSession(const std::filesystem::path &model) const {
+    Ort::Session MLRuntime::createSession(const std::filesystem::path &model, const SessionConfig &config) const {
         Ort::SessionOptions session_options;
 #ifdef ML_BACKEND_VERBOSE_LOGS
         session_options.SetLogSeverityLevel(ORT_LOGGING_LEVEL_VERBOSE);
 #endif
         session_options.SetExecutionMode(ORT_PARALLEL);
         session_options.SetGraphOptimizationLevel(ORT_ENABLE_ALL);
+        if (!config.profilingPrefix.empty()) {
+            session_options.EnableProfiling(config.profilingPrefix.c_str());
+        }
 #ifdef __APPLE__
         uint32_t coreml_flags = COREML_FLAG_ENABLE_ON_SUBGRAPH;
         Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_CoreML(session_options, coreml_flags));
 #endif
+        if (config.sharePrepackedWeights) {
+            // Sessions on the same model re-use the weights that were pre-packed by the first one
+            return {env_, model.c_str(), session_options, prepackedWeights_};
+        }
         return {env_, model.c_str(), session_options};
     }
 }
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include <ml/nms.hpp>
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace {
+    using namespace ivd::ml;
+
+    // Below this number of candidates dispatching to the thread pool costs more than it saves
+    const constexpr size_t parallelThreshold = 1024;
+
+    void suppress(const BoxCandidates &candidates, const std::vector<float> &areas, const int *order, size_t count,
+                  float iouThreshold, std::vector<char> &suppressed, std::vector<int> &keep) {
+        suppressed.assign(count, 0);
+        const auto *x1 = candidates.x1.data();
+        const auto *y1 = candidates.y1.data();
+        const auto *x2 = candidates.x2.data();
+        const auto *y2 = candidates.y2.data();
+
+        for (size_t a = 0; a < count; a++) {
+            if (suppressed[a]) {
+                continue;
+            }
+
+            const auto i = order[a];
+            keep.push_back(i);
+
+            for (size_t b = a + 1; b < count; b++) {
+                if (suppressed[b]) {
+                    continue;
+                }
+
+                const auto j = order[b];
+                const float w = std::min(x2[i], x2[j]) - std::max(x1[i], x1[j]);
+                const float h = std::min(y2[i], y2[j]) - std::max(y1[i], y1[j]);
+                if (w <= 0 || h <= 0) {
+                    continue;
+                }
+
+                // iou > threshold, without the division
+                const float intersection = w * h;
+                if (intersection > iouThreshold * (areas[i] + areas[j] - intersection)) {
+                    suppressed[b] = 1;
+                }
+            }
+        }
+    }
+}
+
+namespace ivd::ml {
+
+    void BoxCandidates::reserve(size_t capacity) {
+        x1.reserve(capacity);
+        y1.reserve(capacity);
+        x2.reserve(capacity);
+        y2.reserve(capacity);
+        scores.reserve(capacity);
+        classIds.reserve(capacity);
+    }
+
+    void BoxCandidates::clear() {
+        x1.clear();
+        y1.clear();
+        x2.clear();
+        y2.clear();
+        scores.clear();
+        classIds.clear();
+    }
+
+    void BoxCandidates::push_back(float left, float top, float right, float bottom, float score, int classId) {
+        x1.push_back(left);
+        y1.push_back(top);
+        x2.push_back(right);
+        y2.push_back(bottom);
+        scores.push_back(score);
+        classIds.push_back(classId);
+    }
+
+    std::vector<int> nms(const BoxCandidates &candidates, const NMSOptions &options) {
+        assert(candidates.x1.size() == candidates.size());
+        assert(candidates.classIds.size() == candidates.size());
+
+        // Score filter
+        std::vector<int> order;
+        order.reserve(candidates.size());
+        for (int i = 0; i < int(candidates.size()); i++) {
+            if (candidates.scores[i] > options.scoreThreshold) {
+                order.push_back(i);
+            }
+        }
+
+        auto byScore = [&](int a, int b) { return candidates.scores[a] > candidates.scores[b]; };
+
+        // Top-k pre-selection, then a single (stable, ties keep input order) sort
+        if (options.topK > 0 && order.size() > options.topK) {
+            std::nth_element(order.begin(), order.begin() + options.topK, order.end(), byScore);
+            order.resize(options.topK);
+            std::sort(order.begin(), order.end());
+        }
+        std::stable_sort(order.begin(), order.end(), byScore);
+
+        if (order.empty()) {
+            return {};
+        }
+
+        std::vector<float> areas(candidates.size());
+        for (auto i: order) {
+            areas[i] = (candidates.x2[i] - candidates.x1[i]) * (candidates.y2[i] - candidates.y1[i]);
+        }
+
+        std::vector<int> keep;
+        if (options.classAgnostic) {
+            std::vector<char> suppressed;
+            suppress(candidates, areas, order.data(), order.size(), options.iouThreshold, suppressed, keep);
+            return keep;
+        }
+
+        // Bucket by class, preserving the score order within each class
+        auto maxClass = *std::max_element(candidates.classIds.begin(), candidates.classIds.end());
+        std::vector<int> offsets(maxClass + 2, 0);
+        for (auto i: order) {
+            offsets[candidates.classIds[i] + 1]++;
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        std::vector<int> grouped(order.size());
+        {
+            auto cursor = offsets;
+            for (auto i: order) {
+                grouped[cursor[candidates.classIds[i]]++] = i;
+            }
+        }
+
+        std::vector<int> classes;
+        for (int c = 0; c <= maxClass; c++) {
+            if (offsets[c + 1] > offsets[c]) {
+                classes.push_back(c);
+            }
+        }
+
+        std::vector<std::vector<int>> classKeep(classes.size());
+        auto suppressClasses = [&](const cv::Range &range) {
+            std::vector<char> suppressed;
+            for (int c = range.start; c < range.end; c++) {
+                auto cls = classes[c];
+                suppress(candidates, areas, grouped.data() + offsets[cls], offsets[cls + 1] - offsets[cls],
+                         options.iouThreshold, suppressed, classKeep[c]);
+            }
+        };
+
+        if (order.size() < parallelThreshold) {
+            suppressClasses(cv::Range(0, int(classes.size())));
+        } else {
+            cv::parallel_for_(cv::Range(0, int(classes.size())), suppressClasses);
+        }
+
+        for (auto &k: classKeep) {
+            keep.insert(keep.end(), k.begin(), k.end());
+        }
+        std::sort(keep.begin(), keep.end(), [&](int a, int b) {
+            return candidates.scores[a] > candidates.scores[b] || (candidates.scores[a] == candidates.scores[b] && a < b);
+        });
+        return keep;
+    }
+}
@@ -0,0 +1,108 @@
+#include <ml/profiling.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace ivd::ml {
+
+    LatencyHistogram::LatencyHistogram(size_t capacity) : capacity_(capacity) {
+        assert(capacity_ > 0);
+    }
+
+    void LatencyHistogram::record(double ms) {
+        if (samples_.size() < capacity_) {
+            samples_.push_back(ms);
+        } else {
+            samples_[next_] = ms;
+        }
+        next_ = (next_ + 1) % capacity_;
+        count_++;
+        sum_ += ms;
+        max_ = std::max(max_, ms);
+    }
+
+    double LatencyHistogram::percentile(double p) const {
+        assert(p >= 0 && p <= 100);
+        if (samples_.empty()) {
+            return 0;
+        }
+
+        auto sorted = samples_;
+        auto rank = size_t(std::ceil(p / 100.0 * sorted.size()));
+        auto nth = sorted.begin() + std::clamp<size_t>(rank, 1, sorted.size()) - 1;
+        std::nth_element(sorted.begin(), nth, sorted.end());
+        return *nth;
+    }
+
+    double LatencyHistogram::mean() const {
+        return count_ > 0 ? sum_ / count_ : 0;
+    }
+
+    void LatencyHistogram::reset() {
+        samples_.clear();
+        next_ = 0;
+        count_ = 0;
+        sum_ = 0;
+        max_ = 0;
+    }
+
+    const char *Profiler::name(Stage stage) {
+        switch (stage) {
+            case Stage::Preprocess:
+                return "preprocess";
+            case Stage::Inference:
+                return "inference";
+            case Stage::Decode:
+                return "decode";
+            case Stage::NMS:
+                return "nms";
+            case Stage::Mask:
+                return "mask";
+            case Stage::Total:
+                return "total";
+        }
+        return "";
+    }
+
+    const char *Profiler::name(Counter counter) {
+        switch (counter) {
+            case Counter::Frames:
+                return "frames";
+            case Counter::Candidates:
+                return "candidates";
+            case Counter::Detections:
+                return "detections";
+        }
+        return "";
+    }
+
+    Profiler::Summary Profiler::summary(Stage stage) const {
+        auto &h = histogram(stage);
+        return {h.count(), h.mean(), h.percentile(50), h.percentile(95), h.percentile(99), h.max()};
+    }
+
+    std::string Profiler::report() const {
+        std::stringstream out;
+        out << std::fixed << std::setprecision(3);
+        for (size_t i = 0; i < stageCount; i++) {
+            auto stage = Stage(i);
+            auto s = summary(stage);
+            out << std::setw(12) << name(stage) << ": n=" << s.count << " mean=" << s.mean << "ms p50=" << s.p50
+                << "ms p95=" << s.p95 << "ms p99=" << s.p99 << "ms max=" << s.max << "ms\n";
+        }
+        for (size_t i = 0; i < counterCount; i++) {
+            out << std::setw(12) << name(Counter(i)) << ": " << counters_[i] << "\n";
+        }
+        return out.str();
+    }
+
+    void Profiler::reset() {
+        for (auto &stage: stages_) {
+            stage.reset();
+        }
+        counters_.fill(0);
+    }
+}
@@ -0,0 +1,87 @@
+#include <ml/stereo_ml_model.hpp>
+
+#include <cassert>
+#include <cstring>
+
+namespace ivd::ml {
+
+    StereoMLModel::StereoMLModel(std::filesystem::path model, const MLRuntime::SessionConfig &sessionConfig,
+                                 const InputOptions &inputOptions)
+            : MLModel(std::move(model), sessionConfig), inputOptions_(inputOptions) {
+        assert(inputNodes().size() == 1 || inputNodes().size() == 2);
+        assert(!outputNodes().empty());
+
+        auto &dimensions = inputNodes()[0].dimensions;
+        assert(dimensions.size() == 4); // NCHW
+        stacked_ = inputNodes().size() == 1;
+        channels_ = int(stacked_ ? dimensions[1] / 2 : dimensions[1]);
+        assert(channels_ == 1 || channels_ == 3);
+        height_ = dimensions[2];
+        width_ = dimensions[3];
+    }
+
+    cv::Size StereoMLModel::inputSize(const cv::Size &imageSize) const {
+        const int alignment = 32;
+        return {width_ > 0 ? int(width_) : std::max(alignment, imageSize.width / alignment * alignment),
+                height_ > 0 ? int(height_) : std::max(alignment, imageSize.height / alignment * alignment)};
+    }
+
+    cv::Mat StereoMLModel::blob(const cv::Mat &image, const cv::Size &size) const {
+        cv::Mat converted = image;
+        if (channels_ == 1 && image.channels() == 3) {
+            cv::cvtColor(image, converted, cv::COLOR_BGR2GRAY);
+        } else if (channels_ == 3 && image.channels() == 1) {
+            cv::cvtColor(image, converted, cv::COLOR_GRAY2BGR);
+        }
+        return cv::dnn::blobFromImage(converted, inputOptions_.scale, size, inputOptions_.mean, inputOptions_.swapRB,
+                                      false);
+    }
+
+    cv::Mat StereoMLModel::predict(const cv::Mat &left, const cv::Mat &right) {
+        cv::Mat disparity;
+        predict(left, right, disparity);
+        return disparity;
+    }
+
+    void StereoMLModel::predict(const cv::Mat &left, const cv::Mat &right, cv::Mat &disparity) {
+        assert(left.size() == right.size());
+        auto size = inputSize(left.size());
+        auto leftBlob = blob(left, size);
+        auto rightBlob = blob(right, size);
+
+        auto memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        std::vector<Ort::Value> inputs;
+        cv::Mat stacked;
+        if (stacked_) {
+            // [1, 2C, H, W], the channels of a blob are contiguous planes
+            std::vector<int64_t> shape{1, 2 * channels_, size.height, size.width};
+            stacked.create(1, int(leftBlob.total() + rightBlob.total()), CV_32F);
+            std::memcpy(stacked.data, leftBlob.data, leftBlob.total() * sizeof(float));
+            std::memcpy(stacked.ptr<float>() + leftBlob.total(), rightBlob.data, rightBlob.total() * sizeof(float));
+            inputs.push_back(Ort::Value::CreateTensor<float>(memoryInfo, stacked.ptr<float>(), stacked.total(),
+                                                             shape.data(), shape.size()));
+        } else {
+            std::vector<int64_t> shape{1, channels_, size.height, size.width};
+            inputs.push_back(Ort::Value::CreateTensor<float>(memoryInfo, leftBlob.ptr<float>(), leftBlob.total(),
+                                                             shape.data(), shape.size()));
+            inputs.push_back(Ort::Value::CreateTensor<float>(memoryInfo, rightBlob.ptr<float>(), rightBlob.total(),
+                                                             shape.data(), shape.size()));
+        }
+
+        auto outputs = session_.Run(Ort::RunOptions{nullptr}, inputNames_.data(), inputs.data(), inputs.size(),
+                                    outputNames_.data(), 1);
+
+        // First channel of the first output, [.., H, W]
+        auto shape = outputs[0].GetTensorTypeAndShapeInfo().GetShape();
+        assert(shape.size() >= 2);
+        auto outputHeight = int(shape[shape.size() - 2]);
+        auto outputWidth = int(shape[shape.size() - 1]);
+        cv::Mat output(outputHeight, outputWidth, CV_32F, outputs[0].GetTensorMutableData<float>());
+
+        // Disparities are in pixels of the input resolution
+        cv::resize(output, disparity, left.size(), 0, 0, cv::INTER_LINEAR);
+        if (outputWidth != left.cols) {
+            disparity *= double(left.cols) / outputWidth;
+        }
+    }
+}
@@ -0,0 +1,134 @@
+#include <ml/temporal_detector.hpp>
+
+#include <algorithm>
+#include <optional>
+
+namespace {
+    using namespace ivd::ml;
+
+    std::vector<Detection> propagate(const std::vector<Detection> &detections, cv::Point2d shift,
+                                     const cv::Size &imageSize) {
+        const cv::Point offset(int(std::round(shift.x)), int(std::round(shift.y)));
+
+        std::vector<Detection> result;
+        result.reserve(detections.size());
+        for (auto &detection: detections) {
+            cv::Rect moved = cv::Rect(detection.bbox) + offset;
+            cv::Rect clipped = moved & cv::Rect({}, imageSize);
+            if (clipped.empty()) {
+                continue;
+            }
+
+            Detection propagated = detection;
+            propagated.bbox = clipped;
+            if (!detection.mask.empty()) {
+                // Masks are relative to the box, crop the part that moved out of the image
+                propagated.mask = detection.mask(clipped - moved.tl());
+            }
+            result.push_back(std::move(propagated));
+        }
+        return result;
+    }
+
+    double iou(const cv::Rect_<float> &a, const cv::Rect_<float> &b) {
+        auto intersection = (a & b).area();
+        auto unionArea = a.area() + b.area() - intersection;
+        return unionArea > 0 ? intersection / unionArea : 0;
+    }
+}
+
+namespace ivd::ml {
+
+    TemporalDetector::TemporalDetector(DetectMLModel &model, Options options) : model_(model), options_(options) {
+    }
+
+    std::vector<Detection> TemporalDetector::predict(const cv::Mat &image,
+                                                     DetectMLModel::PredictionOptions predictionOptions) {
+        stats_.frames++;
+        auto current = thumbnail(image);
+
+        if (!keyThumbnail_.empty() && keyThumbnail_.size() == current.size() &&
+            skipped_ < options_.maxSkippedFrames) {
+            // Global shift since the key frame, then the change that remains after compensating for it
+            auto shift = cv::phaseCorrelate(keyThumbnail_, current, window_);
+            cv::Mat compensated;
+            cv::Mat translation = (cv::Mat_<double>(2, 3) << 1, 0, shift.x, 0, 1, shift.y);
+            cv::warpAffine(keyThumbnail_, compensated, translation, current.size(), cv::INTER_LINEAR,
+                           cv::BORDER_REPLICATE);
+            auto change = cv::mean(cv::abs(current - compensated))[0];
+
+            if (change < options_.changeThreshold) {
+                auto scale = image.cols / double(current.cols);
+                auto detections = propagate(keyDetections_, shift * scale, image.size());
+                skipped_++;
+                stats_.skipped++;
+
+                if (options_.measureDrift) {
+                    measureDrift(detections, model_.predict(image, predictionOptions));
+                }
+                return detections;
+            }
+        }
+
+        // (Re-)infer and make this the key frame
+        keyDetections_ = model_.predict(image, predictionOptions);
+        keyThumbnail_ = current;
+        skipped_ = 0;
+        stats_.inferred++;
+        return keyDetections_;
+    }
+
+    void TemporalDetector::reset() {
+        keyThumbnail_ = cv::Mat();
+        keyDetections_.clear();
+        skipped_ = 0;
+    }
+
+    cv::Mat TemporalDetector::thumbnail(const cv::Mat &image) {
+        cv::Mat gray;
+        if (image.channels() == 3) {
+            cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+        } else {
+            gray = image;
+        }
+
+        cv::Size size(options_.thumbnailWidth, std::max(1, int(std::round(
+                options_.thumbnailWidth * image.rows / double(image.cols)))));
+        cv::Mat small;
+        cv::resize(gray, small, size, 0, 0, cv::INTER_AREA);
+        small.convertTo(small, CV_32F);
+
+        // Hanning window suppresses the edge effects in phase correlation
+        if (window_.size() != size) {
+            cv::createHanningWindow(window_, size, CV_32F);
+        }
+        return small;
+    }
+
+    void TemporalDetector::measureDrift(const std::vector<Detection> &propagated, const std::vector<Detection> &inferred) {
+        std::vector<bool> matched(propagated.size(), false);
+        for (auto &reference: inferred) {
+            double best = 0;
+            std::optional<size_t> bestIdx;
+            for (size_t i = 0; i < propagated.size(); i++) {
+                if (propagated[i].classIndex != reference.classIndex || matched[i]) {
+                    continue;
+                }
+                auto overlap = iou(propagated[i].bbox, reference.bbox);
+                if (overlap > best) {
+                    best = overlap;
+                    bestIdx = i;
+                }
+            }
+
+            stats_.driftSamples++;
+            stats_.driftIoUSum += best;
+            if (bestIdx && best >= 0.5) {
+                matched[*bestIdx] = true;
+            } else {
+                stats_.missed++;
+            }
+        }
+        stats_.spurious += std::count(matched.begin(), matched.end(), false);
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace ivd::stereo {
+
+    /**
+     * Confidence (CV_32F, 0..1) of left disparities from their left-right consistency: 1 where the right
+     * disparity at x - d agrees, falling linearly to 0 at maxDifference px. Invalid left disparities (<= 0) and
+     * pixels whose match falls outside of the right image get 0. With a non-zero SGBMParameters::uniquenessRatio
+     * the disparities SGBM rejects as not unique are invalid already, so they get 0 as well.
+     */
+    void leftRightConfidence(const cv::Mat &leftDisparity, const cv::Mat &rightDisparity, cv::Mat &confidence,
+                             float maxDifference = 2);
+
+    cv::Mat leftRightConfidence(const cv::Mat &leftDisparity, const cv::Mat &rightDisparity,
+                                float maxDifference = 2);
+}
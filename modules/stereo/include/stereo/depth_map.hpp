@@ -1,10 +1,69 @@
 #pragma once
 
+#include <common/quantile.hpp>
+
 #include <opencv2/opencv.hpp>
 
+#include <optional>
+#include <vector>
+
 namespace ivd::stereo {
     cv::Mat
     calculateDepthMap(cv::Mat &disparityLeft, const cv::Mat &K_left, const cv::Mat &T_left, const cv::Mat &T_right);
 
+    // Depth maps of all functions below can be in any of the common/depth_format.hpp formats
     double getDepth(const cv::Mat& depthMap, cv::Rect box);
-}
\ No newline at end of file
+
+    struct DepthQuery {
+        // 0.5 == median
+        double quantile{0.5};
+        // Depths outside of (0, histogram.max) are invalid, the error is below a bin (5cm)
+        common::HistogramQuantiles histogram{0, 120, 2400};
+    };
+
+    /**
+     * Robust depth of a box. Only valid depths count, so neither the 0 of DepthMapCalculator nor the huge
+     * placeholder depths calculateDepthMap gives invalid disparities. Where given, only pixels where mask
+     * (CV_8U, size of box) is set count and every depth is weighted by confidence (CV_32F, size of the depth
+     * map, eg leftRightConfidence). Weighted quantile from a histogram in a single pass over the box.
+     */
+    std::optional<double> getDepth(const cv::Mat &depthMap, const cv::Rect &box, const cv::Mat &mask,
+                                   const cv::Mat &confidence = {}, const DepthQuery &query = {});
+
+    // Robust depths of all boxes of a frame in parallel, masks are empty or one (possibly empty) per box
+    std::vector<std::optional<double>> getDepths(const cv::Mat &depthMap, const std::vector<cv::Rect> &boxes,
+                                                 const std::vector<cv::Mat> &masks = {},
+                                                 const cv::Mat &confidence = {}, const DepthQuery &query = {});
+
+    /**
+     * Depth (CV_32F, m) from disparity without touching the disparity and without allocating once the output
+     * exists. SGBM disparities are quantized to 1/16 px, so depth = f * b / disparity is a lookup of the
+     * disparity * 16 in a reciprocal table. Pixels without a valid disparity (<= 0) get depth 0.
+     */
+    class DepthMapCalculator {
+    public:
+        DepthMapCalculator(const cv::Mat &K_left, const cv::Mat &T_left, const cv::Mat &T_right,
+                           int maxDisparity = 256);
+
+        DepthMapCalculator(double focalLength, double baseline, int maxDisparity = 256);
+
+        // Disparity as CV_32F (px) or the raw SGBM output (CV_16S, scaled by 16)
+        void compute(const cv::Mat &disparity, cv::Mat &depth) const;
+
+        cv::Mat compute(const cv::Mat &disparity) const;
+
+        double focalLength() const {
+            return focalLength_;
+        }
+
+        double baseline() const {
+            return baseline_;
+        }
+
+    private:
+        double focalLength_;
+        double baseline_;
+        // f * b / (i / 16), 0 for i == 0
+        std::vector<float> reciprocal_;
+    };
+}
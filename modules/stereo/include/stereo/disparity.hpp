@@ -3,6 +3,65 @@
 #include <opencv2/opencv.hpp>
 
 namespace ivd::stereo {
+
+    // See cv::StereoSGBM::create
+    struct SGBMParameters {
+        int minDisparity{0};
+        int numDisparities{80};
+        int blockSize{11};
+        // Smoothness penalties, 8 * 3 * windowSize^2 and 32 * 3 * windowSize^2 with windowSize 5
+        int P1{600};
+        int P2{2400};
+        int disp12MaxDiff{0};
+        int preFilterCap{0};
+        // Margin (%) by which the best match cost must beat the second best, eg 10. Ambiguous pixels are
+        // invalid (minDisparity - 1). 0 == off
+        int uniquenessRatio{0};
+        int speckleWindowSize{0};
+        int speckleRange{0};
+        int mode{cv::StereoSGBM::MODE_SGBM_3WAY};
+    };
+
+    /**
+     * Keeps one SGBM matcher (and its internal buffers) alive across frames. Disparities are in pixels (CV_32F),
+     * converted from the matcher's fixed point output (CV_16S, scaled by 16) in a single pass.
+     */
+    class DisparityEstimator {
+    public:
+        explicit DisparityEstimator(const SGBMParameters &parameters = {});
+
+        const SGBMParameters &parameters() const {
+            return parameters_;
+        }
+
+        void setParameters(const SGBMParameters &parameters);
+
+        // Changes only the search range, keeps the matcher and its buffers
+        void setRange(int minDisparity, int numDisparities);
+
+        // Rectified CV_8U pair
+        cv::Mat compute(const cv::Mat &left, const cv::Mat &right);
+
+        // Into disparity, reused when it has the right size and type
+        void compute(const cv::Mat &left, const cv::Mat &right, cv::Mat &disparity);
+
+        /**
+         * Disparity of the right image (right pixel x matches left pixel x + d), from matching the mirrored pair
+         * with the same matcher. For left-right consistency checks, see leftRightConfidence.
+         */
+        void computeRight(const cv::Mat &left, const cv::Mat &right, cv::Mat &disparity);
+
+        // Fixed point disparity (CV_16S, scaled by 16) of the last compute (mirrored after computeRight)
+        const cv::Mat &raw() const {
+            return raw_;
+        }
+
+    private:
+        SGBMParameters parameters_;
+        cv::Ptr<cv::StereoSGBM> matcher_;
+        cv::Mat raw_;
+        cv::Mat leftMirrored_, rightMirrored_, mirrored_;
+    };
+
     cv::Mat disparityMapSGBM(const cv::Mat &left, const cv::Mat &right);
 }
-
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stereo/disparity.hpp>
+
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+
+namespace ivd::stereo {
+
+    struct StripOptions {
+        // 0 == one strip per thread (cv::getNumThreads). Each strip runs its matcher on a single thread (nested
+        // parallel_for_ is serial), so this sets the number of threads used. Capped so that a strip is at least
+        // two blocks high, eg 17 strips for a 375 row KITTI frame with blockSize 11
+        int strips{0};
+        // Extra rows matched above and below each strip, covers the block window and lets the vertical
+        // aggregation path settle before the rows that are kept
+        int overlap{24};
+    };
+
+    /**
+     * Strip parallel SGBM: the rectified pair is split into horizontal strips that are matched concurrently,
+     * each with its own matcher, and stitched. Scales with the number of cores where a single matcher does not.
+     * Disparities match DisparityEstimator up to the vertical aggregation near the strip borders.
+     */
+    class StripDisparityEstimator {
+    public:
+        explicit StripDisparityEstimator(const SGBMParameters &parameters = {}, const StripOptions &options = {});
+
+        const SGBMParameters &parameters() const {
+            return parameters_;
+        }
+
+        const StripOptions &options() const {
+            return options_;
+        }
+
+        // Number of strips actually used for an image of rows
+        int stripCount(int rows) const;
+
+        cv::Mat compute(const cv::Mat &left, const cv::Mat &right);
+
+        void compute(const cv::Mat &left, const cv::Mat &right, cv::Mat &disparity);
+
+    private:
+        SGBMParameters parameters_;
+        StripOptions options_;
+        std::vector<DisparityEstimator> estimators_;
+        std::vector<cv::Mat> stripDisparities_;
+    };
+}
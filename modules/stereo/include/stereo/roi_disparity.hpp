@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stereo/disparity.hpp>
+
+#include <opencv2/opencv.hpp>
+
+#include <optional>
+#include <vector>
+
+namespace ivd::stereo {
+
+    // Region of the left image to compute disparities for, with its disparity search range
+    struct DisparityRegion {
+        cv::Rect rect;
+        int minDisparity;
+        // Multiple of 16
+        int numDisparities;
+    };
+
+    /**
+     * Region searching the disparities low to high (px, eg quantiles of a prior plus a margin), clamped to the
+     * range of parameters and widened to a multiple of 16. Empty when low to high misses that range.
+     */
+    std::optional<DisparityRegion> rangeRegion(const cv::Rect &rect, double low, double high,
+                                               const SGBMParameters &parameters);
+
+    struct RoiOptions {
+        // Narrow the range per box with a low resolution full frame pass (0 == off, search the full range)
+        int seedScale{4};
+        // Quantiles of the seed disparities in a box that bound its range
+        double seedLow{0.02};
+        double seedHigh{0.98};
+        // Added around the seeded range (px at full resolution), covers the seed's quantization
+        int seedMargin{8};
+        // Rows matched above and below a region, lets the aggregation settle
+        int overlap{16};
+    };
+
+    /**
+     * Computes disparities only for the requested boxes, eg detections, each padded to the left by its
+     * disparity search range (the first minDisparity + numDisparities columns SGBM sees have no match).
+     * Pixels outside of the regions are invalid (minDisparity - 1, as SGBM marks them).
+     */
+    class RoiDisparityEstimator {
+    public:
+        explicit RoiDisparityEstimator(const SGBMParameters &parameters = {}, const RoiOptions &options = {});
+
+        const SGBMParameters &parameters() const {
+            return parameters_;
+        }
+
+        // Regions with seeded (or full) ranges for boxes
+        std::vector<DisparityRegion> regions(const cv::Mat &left, const cv::Mat &right,
+                                             const std::vector<cv::Rect> &boxes);
+
+        void compute(const cv::Mat &left, const cv::Mat &right, const std::vector<DisparityRegion> &regions,
+                     cv::Mat &disparity);
+
+        cv::Mat compute(const cv::Mat &left, const cv::Mat &right, const std::vector<cv::Rect> &boxes);
+
+    private:
+        SGBMParameters parameters_;
+        RoiOptions options_;
+        DisparityEstimator seed_;
+        cv::Mat leftSmall_, rightSmall_, seedDisparity_;
+        // One matcher per region slot, kept across frames and only re-ranged
+        std::vector<DisparityEstimator> estimators_;
+        std::vector<cv::Mat> matched_, regionDisparities_;
+    };
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stereo/disparity.hpp>
+#include <stereo/roi_disparity.hpp>
+
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+
+namespace ivd::stereo {
+
+    struct TemporalOptions {
+        // Columns x rows
+        cv::Size tiles{6, 3};
+        // Quantiles of the previous disparities in a tile that bound its next range
+        double low{0.01};
+        double high{0.99};
+        // Added around the previous range (px)
+        int margin{8};
+        // A tile whose valid pixels drop below this fraction of the previous frame's is recomputed with the full
+        // range (the scene changed more than the margin covers)
+        double minValidRatio{0.8};
+        // Also when more than this fraction of its disparities sit at the edges of the restricted range (the
+        // true disparities are outside of it, without uniqueness checks SGBM still picks the closest)
+        double maxEdgeFraction{0.2};
+        // Full frame with the full range every n frames (0 == never)
+        int refreshInterval{30};
+    };
+
+    /**
+     * Warm starts SGBM from the previous frame: consecutive frames have similar disparities, so every tile
+     * only searches around the range its disparities had in the previous frame. Falls back to the full range
+     * per tile when its result degrades, and for the whole frame on the first frame and every refreshInterval.
+     */
+    class TemporalDisparityEstimator {
+    public:
+        struct Stats {
+            size_t frames{0};
+            size_t fullFrames{0};
+            size_t tiles{0};
+            // Tiles recomputed with the full range
+            size_t fallbackTiles{0};
+            // Disparities searched (pixels * range), relative to the full range
+            double searched{0};
+            double full{0};
+            double warmMs{0};
+            double fullMs{0};
+
+            double rangeReduction() const {
+                return full > 0 ? 1 - searched / full : 0;
+            }
+
+            // Mean runtime of warm started frames relative to full frames
+            double timeSaved() const {
+                auto warmFrames = frames - fullFrames;
+                if (warmFrames == 0 || fullFrames == 0) {
+                    return 0;
+                }
+                return 1 - (warmMs / double(warmFrames)) / (fullMs / double(fullFrames));
+            }
+        };
+
+        explicit TemporalDisparityEstimator(const SGBMParameters &parameters = {},
+                                            const TemporalOptions &options = {});
+
+        cv::Mat compute(const cv::Mat &left, const cv::Mat &right);
+
+        void compute(const cv::Mat &left, const cv::Mat &right, cv::Mat &disparity);
+
+        // Next frame uses the full range
+        void reset();
+
+        const Stats &stats() const {
+            return stats_;
+        }
+
+    private:
+        std::vector<cv::Rect> tiles(const cv::Size &size) const;
+
+        std::vector<DisparityRegion> warmRegions(const std::vector<cv::Rect> &tiles) const;
+
+    private:
+        SGBMParameters parameters_;
+        TemporalOptions options_;
+        DisparityEstimator full_;
+        RoiDisparityEstimator regions_;
+
+        cv::Mat previous_;
+        // Valid pixel fraction per tile in the previous frame
+        std::vector<double> previousValid_;
+        Stats stats_;
+    };
+}
@@ -0,0 +1,40 @@
+#include <stereo/confidence.hpp>
+
+#include <cmath>
+
+namespace ivd::stereo {
+
+    void leftRightConfidence(const cv::Mat &leftDisparity, const cv::Mat &rightDisparity, cv::Mat &confidence,
+                             float maxDifference) {
+        assert(leftDisparity.type() == CV_32F);
+        assert(rightDisparity.type() == CV_32F);
+        assert(leftDisparity.size() == rightDisparity.size());
+        assert(maxDifference > 0);
+
+        confidence.create(leftDisparity.size(), CV_32F);
+        const float slope = 1 / maxDifference;
+
+        cv::parallel_for_(cv::Range(0, leftDisparity.rows), [&](const cv::Range &range) {
+            for (int row = range.start; row < range.end; row++) {
+                auto *left = leftDisparity.ptr<float>(row);
+                auto *right = rightDisparity.ptr<float>(row);
+                auto *out = confidence.ptr<float>(row);
+                for (int col = 0; col < leftDisparity.cols; col++) {
+                    auto d = left[col];
+                    auto match = int(std::lround(col - d));
+                    if (d <= 0 || match < 0) {
+                        out[col] = 0;
+                        continue;
+                    }
+                    out[col] = std::max(0.f, 1 - std::abs(d - right[match]) * slope);
+                }
+            }
+        }, double(leftDisparity.total()) / 65536);
+    }
+
+    cv::Mat leftRightConfidence(const cv::Mat &leftDisparity, const cv::Mat &rightDisparity, float maxDifference) {
+        cv::Mat confidence;
+        leftRightConfidence(leftDisparity, rightDisparity, confidence, maxDifference);
+        return confidence;
+    }
+}
@@ -1,5 +1,6 @@
 #include <stereo/depth_map.hpp>
 
+#include <common/depth_format.hpp>
 #include <common/opencv_utils.hpp>
 
 namespace ivd::stereo {
@@ -26,14 +27,98 @@ namespace ivd::stereo {
     }
 
     double getDepth(const cv::Mat &depthMap, cv::Rect bbox) {
-        assert(depthMap.type() == CV_32F);
         assert(depthMap.channels() == 1);
 
         // Get depth slice for BBox
         cv::Mat depthSlice(depthMap, bbox);
 
         // Return median value of depth slice
-        return ivd::common::median<float>(depthSlice);
+        return common::dispatchDepth(depthMap.type(), [&](auto type) {
+            return ivd::common::median<decltype(type)>(depthSlice) * common::depthUnit(depthMap.type());
+        });
     }
 
-}
\ No newline at end of file
+    std::optional<double> getDepth(const cv::Mat &depthMap, const cv::Rect &box, const cv::Mat &mask,
+                                   const cv::Mat &confidence, const DepthQuery &query) {
+        assert(confidence.empty() || confidence.size() == depthMap.size());
+
+        // Histogram in the units of the depth map
+        const auto unit = common::depthUnit(depthMap.type());
+        auto histogram = query.histogram;
+        histogram.min /= unit;
+        histogram.max /= unit;
+
+        auto result = common::dispatchDepth(depthMap.type(), [&](auto type) {
+            using T = decltype(type);
+            return common::weightedQuantiles<T>(depthMap(box), mask, confidence.empty() ? cv::Mat() : confidence(box),
+                                                std::array<double, 1>{query.quantile},
+                                                [&](const T &z) { return z > 0 && double(z) < histogram.max; },
+                                                histogram);
+        });
+        if (!result) {
+            return {};
+        }
+        return (*result)[0] * unit;
+    }
+
+    std::vector<std::optional<double>> getDepths(const cv::Mat &depthMap, const std::vector<cv::Rect> &boxes,
+                                                 const std::vector<cv::Mat> &masks, const cv::Mat &confidence,
+                                                 const DepthQuery &query) {
+        assert(masks.empty() || masks.size() == boxes.size());
+        return common::parallelQueries(boxes.size(), [&](size_t i) {
+            return getDepth(depthMap, boxes[i], masks.empty() ? cv::Mat() : masks[i], confidence, query);
+        });
+    }
+
+    DepthMapCalculator::DepthMapCalculator(const cv::Mat &K_left, const cv::Mat &T_left, const cv::Mat &T_right,
+                                           int maxDisparity)
+            : DepthMapCalculator(K_left.at<double>(0, 0),
+                                 cv::Mat(cv::abs(T_left.row(0) - T_right.row(0))).at<double>(0), maxDisparity) {
+    }
+
+    DepthMapCalculator::DepthMapCalculator(double focalLength, double baseline, int maxDisparity)
+            : focalLength_(focalLength), baseline_(baseline), reciprocal_(size_t(maxDisparity) * 16 + 1) {
+        assert(maxDisparity > 0);
+        reciprocal_[0] = 0;
+        for (size_t i = 1; i < reciprocal_.size(); i++) {
+            reciprocal_[i] = float(focalLength * baseline * 16 / double(i));
+        }
+    }
+
+    void DepthMapCalculator::compute(const cv::Mat &disparity, cv::Mat &depth) const {
+        assert(disparity.channels() == 1);
+        assert(disparity.type() == CV_32F || disparity.type() == CV_16S);
+
+        depth.create(disparity.size(), CV_32F);
+        const auto *lut = reciprocal_.data();
+        const auto lutSize = int(reciprocal_.size());
+        const auto fb = float(focalLength_ * baseline_);
+
+        cv::parallel_for_(cv::Range(0, disparity.rows), [&](const cv::Range &range) {
+            for (int row = range.start; row < range.end; row++) {
+                auto *out = depth.ptr<float>(row);
+                if (disparity.type() == CV_16S) {
+                    auto *in = disparity.ptr<short>(row);
+                    for (int col = 0; col < disparity.cols; col++) {
+                        auto i = int(in[col]);
+                        out[col] = i <= 0 ? 0.f : i < lutSize ? lut[i] : fb * 16 / float(i);
+                    }
+                } else {
+                    auto *in = disparity.ptr<float>(row);
+                    for (int col = 0; col < disparity.cols; col++) {
+                        auto d = in[col];
+                        auto i = int(d * 16 + 0.5f);
+                        out[col] = d <= 0 ? 0.f : i < lutSize ? lut[std::max(i, 1)] : fb / d;
+                    }
+                }
+            }
+        }, double(disparity.total()) / 65536);
+    }
+
+    cv::Mat DepthMapCalculator::compute(const cv::Mat &disparity) const {
+        cv::Mat depth;
+        compute(disparity, depth);
+        return depth;
+    }
+
+}
@@ -2,53 +2,57 @@
 
 namespace ivd::stereo {
 
-    cv::Mat disparityMapSGBM(const cv::Mat &left, const cv::Mat &right) {
-        assert(left.channels() == 1);
-        assert(right.channels() == 1);
-        assert(left.type() == CV_8U);
-        assert(right.type() == CV_8U);
-        assert(left.size() == right.size());
-
-        // TODO: parameters
-        const constexpr int minDisparity = 0;
-        const constexpr int numDisparities = 80;
-        const constexpr int blockSize = 11;
-        const constexpr int windowSize = 5;
-
-        int P1 = 8 * 3 * std::pow(windowSize, 2);
-        int P2 = 32 * 3 * std::pow(windowSize, 2);
+    DisparityEstimator::DisparityEstimator(const SGBMParameters &parameters) {
+        setParameters(parameters);
+    }
 
-        // TODO: COLO
+    void DisparityEstimator::setParameters(const SGBMParameters &parameters) {
+        parameters_ = parameters;
         // TODO: default values for optional arguments differ from header vs online documentation...
-        auto sgbm = cv::StereoSGBM::create(minDisparity, numDisparities, blockSize,
-                                           P1, P2, 0,
-                                           0, 0,
-                                           0, 0, cv::StereoSGBM::MODE_SGBM_3WAY);
+        matcher_ = cv::StereoSGBM::create(parameters.minDisparity, parameters.numDisparities, parameters.blockSize,
+                                          parameters.P1, parameters.P2, parameters.disp12MaxDiff,
+                                          parameters.preFilterCap, parameters.uniquenessRatio,
+                                          parameters.speckleWindowSize, parameters.speckleRange, parameters.mode);
+    }
 
-//        auto sgbm = cv::StereoSGBM::create(minDisparity, numDisparities, blockSize,
-//                                           P1, P2, 1,
-//                                           0, 5,
-//                                           400, 200, cv::StereoSGBM::MODE_SGBM_3WAY);
+    void DisparityEstimator::setRange(int minDisparity, int numDisparities) {
+        assert(numDisparities > 0 && numDisparities % 16 == 0);
+        parameters_.minDisparity = minDisparity;
+        parameters_.numDisparities = numDisparities;
+        matcher_->setMinDisparity(minDisparity);
+        matcher_->setNumDisparities(numDisparities);
+    }
 
+    cv::Mat DisparityEstimator::compute(const cv::Mat &left, const cv::Mat &right) {
         cv::Mat disparity;
-        sgbm->compute(left, right, disparity);
+        compute(left, right, disparity);
+        return disparity;
+    }
+
+    void DisparityEstimator::compute(const cv::Mat &left, const cv::Mat &right, cv::Mat &disparity) {
+        assert(left.channels() == 1);
+        assert(right.channels() == 1);
+        assert(left.type() == CV_8U);
+        assert(right.type() == CV_8U);
+        assert(left.size() == right.size());
 
-        // Converting disparity values to CV_32F from CV_16S
-        cv::Mat out;
-        disparity.convertTo(out, CV_32F);
+        matcher_->compute(left, right, raw_);
 
-        // Scaling down the disparity values
-        // CV_16S containing a disparity map scaled by 16
-        out = out / 16.0f;
-        // TODO: Normalize?
-        // out = (out / 16.0f - (float) minDisparity) / ((float) numDisparities);
+        // CV_16S containing a disparity map scaled by 16, convert and scale in one pass
+        raw_.convertTo(disparity, CV_32F, 1.0 / 16);
+        assert(disparity.size() == left.size());
+    }
 
-        // TODO: Blur?
+    void DisparityEstimator::computeRight(const cv::Mat &left, const cv::Mat &right, cv::Mat &disparity) {
+        // Mirrored, the right image is the left one of the pair and disparities stay positive
+        cv::flip(right, rightMirrored_, 1);
+        cv::flip(left, leftMirrored_, 1);
+        compute(rightMirrored_, leftMirrored_, mirrored_);
+        cv::flip(mirrored_, disparity, 1);
+    }
 
-        assert(out.size().width == disparity.size().width);
-        assert(out.size().height == disparity.size().height);
-        assert(out.channels() == disparity.channels());
-        return out;
+    cv::Mat disparityMapSGBM(const cv::Mat &left, const cv::Mat &right) {
+        return DisparityEstimator().compute(left, right);
     }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,54 @@
+#include <stereo/parallel_disparity.hpp>
+
+#include <algorithm>
+
+namespace ivd::stereo {
+
+    StripDisparityEstimator::StripDisparityEstimator(const SGBMParameters &parameters, const StripOptions &options)
+            : parameters_(parameters), options_(options) {
+        assert(options.strips >= 0);
+        assert(options.overlap >= 0);
+    }
+
+    int StripDisparityEstimator::stripCount(int rows) const {
+        auto strips = options_.strips > 0 ? options_.strips : cv::getNumThreads();
+        auto minRows = std::max(1, 2 * parameters_.blockSize);
+        return std::max(1, std::min(strips, rows / minRows));
+    }
+
+    cv::Mat StripDisparityEstimator::compute(const cv::Mat &left, const cv::Mat &right) {
+        cv::Mat disparity;
+        compute(left, right, disparity);
+        return disparity;
+    }
+
+    void StripDisparityEstimator::compute(const cv::Mat &left, const cv::Mat &right, cv::Mat &disparity) {
+        assert(left.size() == right.size());
+
+        auto strips = stripCount(left.rows);
+
+        // Matchers and their buffers are kept across frames
+        while (int(estimators_.size()) < strips) {
+            estimators_.emplace_back(parameters_);
+        }
+        stripDisparities_.resize(estimators_.size());
+        disparity.create(left.size(), CV_32F);
+
+        cv::parallel_for_(cv::Range(0, strips), [&](const cv::Range &range) {
+            for (int strip = range.start; strip < range.end; strip++) {
+                auto rowBegin = int(int64_t(left.rows) * strip / strips);
+                auto rowEnd = int(int64_t(left.rows) * (strip + 1) / strips);
+                auto matchBegin = std::max(rowBegin - options_.overlap, 0);
+                auto matchEnd = std::min(rowEnd + options_.overlap, left.rows);
+
+                auto &stripDisparity = stripDisparities_[strip];
+                estimators_[strip].compute(left.rowRange(matchBegin, matchEnd), right.rowRange(matchBegin, matchEnd),
+                                           stripDisparity);
+
+                // Stitch, without the overlap
+                stripDisparity.rowRange(rowBegin - matchBegin, rowEnd - matchBegin)
+                        .copyTo(disparity.rowRange(rowBegin, rowEnd));
+            }
+        });
+    }
+}
@@ -0,0 +1,138 @@
+#include <stereo/roi_disparity.hpp>
+
+#include <common/quantile.hpp>
+
+#include <cmath>
+
+namespace ivd::stereo {
+
+    namespace {
+        int roundUp16(int value) {
+            return std::max(16, (value + 15) / 16 * 16);
+        }
+
+        SGBMParameters seedParameters(const SGBMParameters &parameters, int scale) {
+            auto result = parameters;
+            result.minDisparity = parameters.minDisparity / scale;
+            result.numDisparities = roundUp16((parameters.numDisparities + scale - 1) / scale);
+            result.blockSize = std::max(3, parameters.blockSize / scale) | 1;
+            return result;
+        }
+    }
+
+    std::optional<DisparityRegion> rangeRegion(const cv::Rect &rect, double low, double high,
+                                               const SGBMParameters &parameters) {
+        const int maxDisparity = parameters.minDisparity + parameters.numDisparities;
+        auto first = std::max(int(std::floor(low)), parameters.minDisparity);
+        auto last = std::min(int(std::ceil(high)), maxDisparity);
+        if (last <= first) {
+            return std::nullopt;
+        }
+
+        auto num = std::min(roundUp16(last - first), parameters.numDisparities);
+        return DisparityRegion{rect, std::min(first, maxDisparity - num), num};
+    }
+
+    RoiDisparityEstimator::RoiDisparityEstimator(const SGBMParameters &parameters, const RoiOptions &options)
+            : parameters_(parameters), options_(options),
+              seed_(seedParameters(parameters, std::max(1, options.seedScale))) {
+        assert(options.seedScale >= 0);
+        assert(parameters.numDisparities % 16 == 0);
+    }
+
+    std::vector<DisparityRegion> RoiDisparityEstimator::regions(const cv::Mat &left, const cv::Mat &right,
+                                                                const std::vector<cv::Rect> &boxes) {
+        const cv::Rect image({}, left.size());
+        std::vector<DisparityRegion> result;
+        for (auto &box: boxes) {
+            result.push_back({box & image, parameters_.minDisparity, parameters_.numDisparities});
+        }
+        if (options_.seedScale <= 1 || boxes.empty()) {
+            return result;
+        }
+
+        // Low resolution pass over the full frame
+        const int scale = options_.seedScale;
+        cv::resize(left, leftSmall_, left.size() / scale, 0, 0, cv::INTER_AREA);
+        cv::resize(right, rightSmall_, right.size() / scale, 0, 0, cv::INTER_AREA);
+        seed_.compute(leftSmall_, rightSmall_, seedDisparity_);
+
+        const float seedInvalid = float(seed_.parameters().minDisparity);
+        const cv::Rect small({}, seedDisparity_.size());
+        for (auto &region: result) {
+            cv::Rect seedBox(region.rect.tl() / scale, region.rect.br() / scale + cv::Point(1, 1));
+            seedBox &= small;
+            auto range = common::quantiles<float>(seedDisparity_(seedBox), cv::Mat(),
+                                                  std::array<double, 2>{options_.seedLow, options_.seedHigh},
+                                                  [&](auto &d) { return d > seedInvalid; });
+            if (!range) {
+                continue; // Full range
+            }
+
+            auto seeded = rangeRegion(region.rect, (*range)[0] * scale - options_.seedMargin,
+                                      (*range)[1] * scale + options_.seedMargin, parameters_);
+            if (seeded) {
+                region = *seeded;
+            }
+        }
+        return result;
+    }
+
+    void RoiDisparityEstimator::compute(const cv::Mat &left, const cv::Mat &right,
+                                        const std::vector<DisparityRegion> &regions, cv::Mat &disparity) {
+        assert(left.size() == right.size());
+        disparity.create(left.size(), CV_32F);
+        disparity.setTo(parameters_.minDisparity - 1);
+
+        const cv::Rect image({}, left.size());
+        const int halfBlock = parameters_.blockSize / 2;
+
+        // Matchers and their buffers are kept across frames
+        while (estimators_.size() < regions.size()) {
+            estimators_.emplace_back(parameters_);
+        }
+        matched_.resize(estimators_.size());
+        regionDisparities_.assign(regions.size(), cv::Mat());
+
+        // Regions are matched in parallel, then written in order (they may overlap)
+        cv::parallel_for_(cv::Range(0, int(regions.size())), [&](const cv::Range &range) {
+            for (int i = range.start; i < range.end; i++) {
+                auto &region = regions[i];
+                if (region.rect.empty()) {
+                    continue;
+                }
+                assert(region.numDisparities % 16 == 0);
+                assert((region.rect & image) == region.rect);
+
+                // Pad left by the search range, up and down by the overlap
+                auto pad = region.minDisparity + region.numDisparities + halfBlock;
+                cv::Rect match(cv::Point(region.rect.x - pad, region.rect.y - options_.overlap - halfBlock),
+                               cv::Point(region.rect.br().x + halfBlock,
+                                         region.rect.br().y + options_.overlap + halfBlock));
+                match &= image;
+
+                auto &estimator = estimators_[i];
+                estimator.setRange(region.minDisparity, region.numDisparities);
+                estimator.compute(left(match), right(match), matched_[i]);
+
+                // Outside of its own range a region is invalid, same as the rest of the frame
+                auto &regionDisparity = regionDisparities_[i];
+                regionDisparity = matched_[i](region.rect - match.tl());
+                regionDisparity.setTo(parameters_.minDisparity - 1, regionDisparity < region.minDisparity);
+            }
+        });
+
+        for (size_t i = 0; i < regions.size(); i++) {
+            if (!regionDisparities_[i].empty()) {
+                regionDisparities_[i].copyTo(disparity(regions[i].rect));
+            }
+        }
+    }
+
+    cv::Mat RoiDisparityEstimator::compute(const cv::Mat &left, const cv::Mat &right,
+                                           const std::vector<cv::Rect> &boxes) {
+        cv::Mat disparity;
+        compute(left, right, regions(left, right, boxes), disparity);
+        return disparity;
+    }
+}
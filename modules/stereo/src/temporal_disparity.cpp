@@ -0,0 +1,126 @@
+#include <stereo/temporal_disparity.hpp>
+
+#include <common/quantile.hpp>
+
+#include <chrono>
+
+namespace ivd::stereo {
+
+    TemporalDisparityEstimator::TemporalDisparityEstimator(const SGBMParameters &parameters,
+                                                           const TemporalOptions &options)
+            : parameters_(parameters), options_(options), full_(parameters), regions_(parameters, {0}) {
+        assert(options.tiles.width > 0 && options.tiles.height > 0);
+    }
+
+    cv::Mat TemporalDisparityEstimator::compute(const cv::Mat &left, const cv::Mat &right) {
+        cv::Mat disparity;
+        compute(left, right, disparity);
+        return disparity;
+    }
+
+    void TemporalDisparityEstimator::compute(const cv::Mat &left, const cv::Mat &right, cv::Mat &disparity) {
+        auto start = std::chrono::steady_clock::now();
+        auto tileRects = tiles(left.size());
+        const auto invalid = float(parameters_.minDisparity);
+
+        auto validFraction = [&](const cv::Mat &tile) {
+            return double(cv::countNonZero(tile > invalid)) / double(std::max<size_t>(tile.total(), 1));
+        };
+
+        // Valid disparities within a pixel of the edges of the region's range, unless that is the edge of the full
+        // range anyway
+        auto edgeFraction = [&](const cv::Mat &tile, const DisparityRegion &region) {
+            cv::Mat valid = tile > invalid;
+            int edges = 0;
+            if (region.minDisparity > parameters_.minDisparity) {
+                edges += cv::countNonZero(valid & (tile <= region.minDisparity + 1));
+            }
+            if (region.minDisparity + region.numDisparities < parameters_.minDisparity + parameters_.numDisparities) {
+                edges += cv::countNonZero(tile >= region.minDisparity + region.numDisparities - 2);
+            }
+            return double(edges) / double(std::max(cv::countNonZero(valid), 1));
+        };
+
+        bool fullFrame = previous_.empty() || previous_.size() != left.size() ||
+                         (options_.refreshInterval > 0 && stats_.frames % options_.refreshInterval == 0);
+        if (fullFrame) {
+            full_.compute(left, right, disparity);
+            stats_.fullFrames++;
+            stats_.searched += double(left.total()) * parameters_.numDisparities;
+        } else {
+            auto regions = warmRegions(tileRects);
+            regions_.compute(left, right, regions, disparity);
+
+            // Retry the tiles that degraded with the full range
+            std::vector<DisparityRegion> fallbacks;
+            for (size_t i = 0; i < regions.size(); i++) {
+                auto &region = regions[i];
+                stats_.searched += double(region.rect.area()) * region.numDisparities;
+                auto tile = disparity(region.rect);
+                if (region.numDisparities < parameters_.numDisparities &&
+                    (validFraction(tile) < options_.minValidRatio * previousValid_[i] ||
+                     edgeFraction(tile, region) > options_.maxEdgeFraction)) {
+                    fallbacks.push_back({region.rect, parameters_.minDisparity, parameters_.numDisparities});
+                    stats_.searched += double(region.rect.area()) * parameters_.numDisparities;
+                }
+            }
+            if (!fallbacks.empty()) {
+                cv::Mat retried;
+                regions_.compute(left, right, fallbacks, retried);
+                for (auto &region: fallbacks) {
+                    retried(region.rect).copyTo(disparity(region.rect));
+                }
+                stats_.fallbackTiles += fallbacks.size();
+            }
+        }
+
+        // Keep for the next frame
+        disparity.copyTo(previous_);
+        previousValid_.resize(tileRects.size());
+        for (size_t i = 0; i < tileRects.size(); i++) {
+            previousValid_[i] = validFraction(previous_(tileRects[i]));
+        }
+
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        (fullFrame ? stats_.fullMs : stats_.warmMs) += ms;
+        stats_.full += double(left.total()) * parameters_.numDisparities;
+        stats_.tiles += tileRects.size();
+        stats_.frames++;
+    }
+
+    void TemporalDisparityEstimator::reset() {
+        previous_ = cv::Mat();
+        previousValid_.clear();
+    }
+
+    std::vector<cv::Rect> TemporalDisparityEstimator::tiles(const cv::Size &size) const {
+        std::vector<cv::Rect> result;
+        auto &grid = options_.tiles;
+        for (int row = 0; row < grid.height; row++) {
+            for (int col = 0; col < grid.width; col++) {
+                cv::Point tl(size.width * col / grid.width, size.height * row / grid.height);
+                cv::Point br(size.width * (col + 1) / grid.width, size.height * (row + 1) / grid.height);
+                result.emplace_back(tl, br);
+            }
+        }
+        return result;
+    }
+
+    std::vector<DisparityRegion> TemporalDisparityEstimator::warmRegions(const std::vector<cv::Rect> &tiles) const {
+        const auto invalid = float(parameters_.minDisparity);
+
+        std::vector<DisparityRegion> result;
+        for (auto &tile: tiles) {
+            DisparityRegion region{tile, parameters_.minDisparity, parameters_.numDisparities};
+            auto range = common::quantiles<float>(previous_(tile), cv::Mat(),
+                                                  std::array<double, 2>{options_.low, options_.high},
+                                                  [&](auto &d) { return d > invalid; });
+            if (range) {
+                region = rangeRegion(tile, (*range)[0] - options_.margin, (*range)[1] + options_.margin, parameters_)
+                        .value_or(region);
+            }
+            result.push_back(region);
+        }
+        return result;
+    }
+}
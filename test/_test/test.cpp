@@ -2,6 +2,8 @@
 
 #include <mapbox/pixelmatch.hpp>
 
+#include <fstream>
+
 namespace ivd::test {
 
     uint64_t
@@ -18,4 +20,27 @@ namespace ivd::test {
         return MODELS_DIR;
     }
 
+    cv::Mat getVeloCam2Projection() {
+        return (cv::Mat_<double>(3, 4) <<
+                6.09695406e+02, -7.21421595e+02, -1.25125972e+00, -7.83959658e+01,
+                1.80384201e+02, 7.64480142e+00, -7.19651522e+02, -1.00984287e+02,
+                9.99945384e-01, 1.24365765e-04, 1.04513027e-02, -2.66641028e-01);
+    }
+
+    StereoCalibration getStereoCalibration() {
+        // One value per line
+        auto read = [](const std::filesystem::path &file) {
+            std::vector<double> values;
+            std::ifstream input(file);
+            double value;
+            while (input >> value) {
+                values.push_back(value);
+            }
+            return cv::Mat(values, true);
+        };
+
+        auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+        return {read(baseDir / "K_left.txt"), read(baseDir / "T_left.txt"), read(baseDir / "T_right.txt")};
+    }
+
 }
@@ -2,7 +2,9 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
 
+#include <chrono>
 #include <filesystem>
 
 namespace ivd::test {
@@ -11,6 +13,32 @@ namespace ivd::test {
 
     std::filesystem::path getFixturesPath();
 
+    // Velodyne -> left color camera projection (3x4) of the lidar and stereo 00_basic fixtures
+    cv::Mat getVeloCam2Projection();
+
+    // Left intrinsics and camera translations of the stereo 00_basic fixture, as read from its *.txt files
+    struct StereoCalibration {
+        cv::Mat K_left;
+        cv::Mat T_left;
+        cv::Mat T_right;
+    };
+
+    StereoCalibration getStereoCalibration();
+
+    // Mean wall time (ms) of fn over iterations, after warmup untimed calls
+    template<class Fn>
+    double timeMs(Fn &&fn, int iterations = 20, int warmup = 1) {
+        for (int i = 0; i < warmup; i++) {
+            fn();
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            fn();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    }
+
     uint64_t pixelmatch(const uint8_t *img1,
                         std::size_t stride1,
                         const uint8_t *img2,
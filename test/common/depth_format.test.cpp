@@ -0,0 +1,75 @@
+#include <test.hpp>
+
+#include <common/depth_format.hpp>
+
+#include <opencv2/opencv.hpp>
+
+#include <random>
+
+using namespace ivd;
+using namespace ivd::test;
+
+namespace {
+    // Mostly empty depth map with depths in 0..80
+    cv::Mat createDepth(cv::Size size, int type, uint32_t seed = 42) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> uniform(0, 1);
+        cv::Mat result(size, CV_64F, cv::Scalar(0));
+        for (int row = 0; row < size.height; row++) {
+            for (int col = 0; col < size.width; col++) {
+                if (uniform(rng) < 0.1) {
+                    result.at<double>(row, col) = 1 + uniform(rng) * 79;
+                }
+            }
+        }
+        result.convertTo(result, type);
+        return result;
+    }
+}
+
+TEST(DepthFormat, RoundTrip) {
+    auto depth = createDepth({300, 200}, CV_64F);
+
+    // 16U: fixed steps
+    auto fixed = common::convertDepth(depth, CV_16U);
+    ASSERT_EQ(fixed.type(), CV_16U);
+    ASSERT_EQ(fixed.size(), depth.size());
+    auto back = common::convertDepth(fixed, CV_64F);
+    ASSERT_LE(cv::norm(back, depth, cv::NORM_INF), 0.5 / common::depthScale16U + 1e-9);
+
+    // 16F: relative steps
+    auto half = common::convertDepth(depth, CV_16F);
+    ASSERT_EQ(half.type(), CV_16F);
+    back = common::convertDepth(half, CV_64F);
+    cv::Mat relative = cv::abs(back - depth) / cv::max(depth, 1);
+    ASSERT_LE(cv::norm(relative, cv::NORM_INF), 1.0 / 1024);
+
+    // Empty pixels stay empty
+    for (auto &compact: {fixed, half}) {
+        ASSERT_EQ(cv::countNonZero(common::convertDepth(compact, CV_32F)), cv::countNonZero(depth));
+    }
+
+    // Negative saturates to empty, far to the largest depth
+    auto edge = common::convertDepth(cv::Mat((cv::Mat_<float>(1, 2) << -1, 1000)), CV_16U);
+    ASSERT_EQ(edge.at<uint16_t>(0), 0);
+    ASSERT_EQ(edge.at<uint16_t>(1), 65535);
+}
+
+TEST(DepthFormat, Reused) {
+    auto depth = createDepth({300, 200}, CV_32F);
+    cv::Mat out;
+    common::convertDepth(depth, out, CV_16U);
+    auto *data = out.data;
+    common::convertDepth(depth, out, CV_16U);
+    ASSERT_EQ(out.data, data);
+}
+
+TEST(DepthFormat, Dispatch) {
+    for (auto type: {CV_64F, CV_32F, CV_16F, CV_16U}) {
+        auto depth = createDepth({10, 10}, type);
+        auto size = common::dispatchDepth(type, [](auto t) { return sizeof(t); });
+        ASSERT_EQ(size, depth.elemSize());
+    }
+    ASSERT_EQ(common::depthUnit(CV_16U), 1 / 256.0);
+    ASSERT_EQ(common::depthUnit(CV_32F), 1);
+}
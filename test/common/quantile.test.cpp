@@ -0,0 +1,191 @@
+#include <test.hpp>
+
+#include <common/opencv_utils.hpp>
+#include <common/quantile.hpp>
+
+#include <random>
+
+using namespace ivd;
+using namespace ivd::test;
+
+namespace {
+    // Depth map like input, mostly empty with depths in 0..80
+    cv::Mat createSparse(cv::Size size, double density, uint32_t seed = 42) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> uniform(0, 1);
+        cv::Mat result(size, CV_64F, cv::Scalar(0));
+        common::iterate<double>(result, [&](auto &val, auto, auto) {
+            if (uniform(rng) < density) {
+                val = uniform(rng) * 80;
+            }
+        });
+        return result;
+    }
+
+    std::vector<double> sorted(const cv::Mat &in, const cv::Mat &mask) {
+        std::vector<double> values;
+        for (int row = 0; row < in.rows; row++) {
+            for (int col = 0; col < in.cols; col++) {
+                if (in.at<double>(row, col) > 0 && (mask.empty() || mask.at<uchar>(row, col))) {
+                    values.push_back(in.at<double>(row, col));
+                }
+            }
+        }
+        std::sort(values.begin(), values.end());
+        return values;
+    }
+
+    auto positive = [](auto &val) { return val > 0; };
+}
+
+TEST(Quantile, Vector) {
+    std::vector<int> values{5, 6, 1, 2, 3, 4, 6, 777, 8};
+    ASSERT_EQ(common::quantile(values, 0.5), 5);
+    ASSERT_EQ(common::quantile(values, 0), 1);
+    ASSERT_EQ(common::quantile(values, 1), 777);
+
+    auto q = common::quantiles(values, std::array<double, 3>{0.9, 0.1, 0.5});
+    ASSERT_EQ(q[0], 777);
+    ASSERT_EQ(q[1], 1);
+    ASSERT_EQ(q[2], 5);
+}
+
+TEST(Quantile, Masked) {
+    auto in = createSparse({200, 100}, 0.3);
+    cv::Mat mask(in.size(), CV_8U, cv::Scalar(0));
+    cv::circle(mask, {100, 50}, 40, cv::Scalar(255), -1);
+
+    for (auto &m: {cv::Mat(), mask}) {
+        auto expected = sorted(in, m);
+        std::array<double, 3> q{0.1, 0.5, 0.9};
+        auto result = common::quantiles<double>(in, m, q, positive);
+        ASSERT_TRUE(result.has_value());
+        for (size_t i = 0; i < q.size(); i++) {
+            ASSERT_EQ((*result)[i], expected[common::quantileIndex(q[i], expected.size())]);
+        }
+    }
+
+    // Same as masking a copy
+    cv::Mat masked;
+    in.copyTo(masked, mask);
+    ASSERT_EQ(common::median<double>(in, mask, positive), common::median<double>(masked, positive));
+
+    // Nothing left
+    ASSERT_FALSE(common::median<double>(in, cv::Mat(in.size(), CV_8U, cv::Scalar(0)), positive).has_value());
+}
+
+TEST(Quantile, Histogram) {
+    auto in = createSparse({400, 300}, 0.3);
+    auto expected = sorted(in, {});
+    common::QuantileOptions options{1, {0, 80, 1024}};
+    const double binWidth = 80.0 / 1024;
+
+    std::array<double, 3> q{0.1, 0.5, 0.9};
+    auto result = common::quantiles<double>(in, cv::Mat(), q, positive, options);
+    ASSERT_TRUE(result.has_value());
+    for (size_t i = 0; i < q.size(); i++) {
+        ASSERT_NEAR((*result)[i], expected[common::quantileIndex(q[i], expected.size())], binWidth);
+    }
+
+    ASSERT_FALSE(common::quantile<double>(cv::Mat(10, 10, CV_64F, cv::Scalar(0)), cv::Mat(), 0.5, positive,
+                                          options).has_value());
+}
+
+TEST(Quantile, Weighted) {
+    auto in = createSparse({400, 300}, 0.3);
+    auto expected = sorted(in, {});
+    common::HistogramQuantiles histogram{0, 80, 1024};
+    const double binWidth = 80.0 / 1024;
+
+    // Uniform weights are the plain quantiles
+    std::array<double, 3> q{0.1, 0.5, 0.9};
+    cv::Mat ones(in.size(), CV_32F, cv::Scalar(1));
+    for (auto &weights: {cv::Mat(), ones}) {
+        auto result = common::weightedQuantiles<double>(in, cv::Mat(), weights, q, positive, histogram);
+        ASSERT_TRUE(result.has_value());
+        for (size_t i = 0; i < q.size(); i++) {
+            ASSERT_NEAR((*result)[i], expected[common::quantileIndex(q[i], expected.size())], 2 * binWidth);
+        }
+    }
+
+    // Heavy weights pull the median
+    auto values = common::createMat<double>({4, 1}, {10, 20, 30, 40});
+    auto weights = common::createMat<float>({4, 1}, {1, 1, 1, 10});
+    auto median = common::weightedQuantiles<double>(values, cv::Mat(), weights, std::array<double, 1>{0.5},
+                                                    positive, histogram);
+    ASSERT_NEAR((*median)[0], 40, binWidth);
+
+    // Zero weights do not count
+    weights = common::createMat<float>({4, 1}, {0, 0, 1, 1});
+    median = common::weightedQuantiles<double>(values, cv::Mat(), weights, std::array<double, 1>{0.5}, positive,
+                                               histogram);
+    ASSERT_GE((*median)[0], 30);
+    ASSERT_FALSE(common::weightedQuantiles<double>(values, cv::Mat(), cv::Mat(values.size(), CV_32F, cv::Scalar(0)),
+                                                   std::array<double, 1>{0.5}, positive, histogram).has_value());
+
+    // Extremes are the smallest and largest values, not the histogram range
+    auto extremes = common::weightedQuantiles<double>(values, cv::Mat(), cv::Mat(), std::array<double, 2>{0, 1},
+                                                      positive, histogram);
+    ASSERT_TRUE(extremes.has_value());
+    ASSERT_NEAR((*extremes)[0], 10, 2 * binWidth);
+    ASSERT_NEAR((*extremes)[1], 40, 2 * binWidth);
+}
+
+TEST(Quantile, ScratchReused) {
+    auto in = createSparse({300, 200}, 0.5);
+    common::median<double>(in, positive);
+    auto *data = common::quantileScratch<double>().data();
+    common::median<double>(in(cv::Rect(10, 10, 100, 100)), positive);
+    ASSERT_EQ(common::quantileScratch<double>().data(), data);
+}
+
+TEST(Quantile, ParallelQueries) {
+    auto in = createSparse({400, 300}, 0.3);
+    std::vector<cv::Rect> boxes;
+    for (int i = 0; i < 40; i++) {
+        boxes.emplace_back(i * 7, i * 5, 100, 80);
+    }
+
+    // In order and the same as serial, every thread uses its own scratch
+    auto results = common::parallelQueries(boxes.size(), [&](size_t i) {
+        return common::median<double>(in(boxes[i]), positive);
+    });
+    ASSERT_EQ(results.size(), boxes.size());
+    for (size_t i = 0; i < boxes.size(); i++) {
+        ASSERT_EQ(results[i], common::median<double>(in(boxes[i]), positive));
+    }
+
+    ASSERT_TRUE(common::parallelQueries(0, [](size_t i) { return i; }).empty());
+}
+
+TEST(Quantile, Benchmark) {
+    auto in = createSparse({1242, 375}, 0.05);
+    cv::Rect bbox{255, 165, 256, 183};
+    cv::Mat mask(bbox.size(), CV_8U, cv::Scalar(0));
+    cv::ellipse(mask, {128, 91}, {100, 91}, 0, 0, 360, cv::Scalar(255), -1);
+    const int iterations = 1000;
+
+    auto time = [&](auto &&fn) {
+        return timeMs(fn, iterations, 0) * 1000;
+    };
+
+    // Previous approach: copy the masked box, copy_if into a fresh vector
+    auto copyUs = time([&]() {
+        cv::Mat masked;
+        in(bbox).copyTo(masked, mask);
+        std::vector<double> tmp;
+        std::copy_if(masked.begin<double>(), masked.end<double>(), std::back_inserter(tmp), positive);
+        std::nth_element(tmp.begin(), tmp.begin() + tmp.size() / 2, tmp.end());
+    });
+    auto scratchUs = time([&]() { common::median<double>(in(bbox), mask, positive); });
+    auto threeUs = time([&]() {
+        common::quantiles<double>(in(bbox), mask, std::array<double, 3>{0.1, 0.5, 0.9}, positive);
+    });
+    auto histogramUs = time([&]() {
+        common::quantiles<double>(in(bbox), mask, std::array<double, 3>{0.1, 0.5, 0.9}, positive,
+                                  {1, {0, 80, 1024}});
+    });
+
+    std::cout << "Masked box median: copy " << copyUs << "us, scratch " << scratchUs << "us, p10/p50/p90 "
+              << threeUs << "us, p10/p50/p90 histogram " << histogramUs << "us" << std::endl;
+}
@@ -0,0 +1,117 @@
+#include <test.hpp>
+
+#include <fusion/fused_depth.hpp>
+#include <kitti/kitti_utils.hpp>
+#include <lidar/lidar.hpp>
+#include <lidar/sparse_depth.hpp>
+
+#include <opencv2/opencv.hpp>
+
+using namespace ivd;
+using namespace ivd::test;
+
+namespace {
+    // The lidar and stereo fixtures are the same frame
+    struct Frame {
+        cv::Mat left;
+        cv::Mat right;
+        lidar::SparseDepthMap lidarDepth;
+    };
+
+    Frame readFrame() {
+        auto stereoDir = getFixturesPath() / "stereo" / "00_basic";
+        auto lidarDir = getFixturesPath() / "lidar" / "00_basic";
+        auto T = getVeloCam2Projection();
+
+        Frame frame{cv::imread(stereoDir / "left.png", cv::IMREAD_GRAYSCALE),
+                    cv::imread(stereoDir / "right.png", cv::IMREAD_GRAYSCALE)};
+        auto projected = lidar::projectVelodyne(kitti::readVeloBin(lidarDir / "lidar_points_raw.bin"), T,
+                                                frame.left.size());
+        frame.lidarDepth.assign(projected, frame.left.size(), lidar::SparseDepthMap::Keep::Nearest);
+        return frame;
+    }
+
+    stereo::DepthMapCalculator calculator() {
+        auto calibration = getStereoCalibration();
+        return {calibration.K_left, calibration.T_left, calibration.T_right};
+    }
+
+    const std::vector<cv::Rect> boxes{{300, 180, 120, 80}, {700, 160, 200, 100}, {1000, 150, 150, 120}};
+}
+
+TEST(FusedDepth, Regions) {
+    auto frame = readFrame();
+    fusion::FusedDepthEstimator estimator(calculator());
+
+    auto regions = estimator.regions(frame.lidarDepth, boxes);
+    ASSERT_EQ(regions.size(), boxes.size());
+    for (auto &region: regions) {
+        std::cout << region.rect << ": disparities " << region.minDisparity << " + " << region.numDisparities
+                  << std::endl;
+        ASSERT_GE(region.minDisparity, 0);
+        ASSERT_LE(region.minDisparity + region.numDisparities, 80);
+        ASSERT_EQ(region.numDisparities % 16, 0);
+    }
+
+    auto &stats = estimator.stats();
+    ASSERT_EQ(stats.regions, boxes.size());
+    ASSERT_GT(stats.seeded, 0);
+    ASSERT_GT(stats.rangeReduction(), 0);
+
+    // Without lidar the full range is searched
+    lidar::SparseDepthMap empty(lidar::ProjectedPoints(), frame.left.size());
+    for (auto &region: estimator.regions(empty, boxes)) {
+        ASSERT_EQ(region.minDisparity, 0);
+        ASSERT_EQ(region.numDisparities, 80);
+    }
+}
+
+TEST(FusedDepth, Compute) {
+    auto frame = readFrame();
+    fusion::FusedDepthEstimator estimator(calculator());
+
+    auto depth = estimator.compute(frame.left, frame.right, frame.lidarDepth, boxes);
+    ASSERT_EQ(depth.type(), CV_32F);
+    ASSERT_EQ(depth.size(), frame.left.size());
+
+    // Nothing outside of the boxes
+    ASSERT_EQ(depth.at<float>(10, 10), 0);
+
+    for (size_t i = 0; i < boxes.size(); i++) {
+        // Lidar wins where both exist
+        frame.lidarDepth.forEach(boxes[i], [&](int col, int row, float z) {
+            ASSERT_EQ(depth.at<float>(row, col), z);
+        });
+
+        auto lidarDepth = frame.lidarDepth.getDepth(boxes[i]);
+        auto fusedDepth = fusion::getDepth(depth, boxes[i]);
+        std::cout << boxes[i] << ": fused " << fusedDepth.value_or(-1) << "m, lidar " << lidarDepth.value_or(-1)
+                  << "m" << std::endl;
+        if (lidarDepth) {
+            // Holes filled
+            ASSERT_TRUE(fusedDepth.has_value());
+            ASSERT_EQ(cv::countNonZero(depth(boxes[i]) == 0), 0);
+            ASSERT_NEAR(*fusedDepth, *lidarDepth, *lidarDepth * 0.15);
+        }
+    }
+}
+
+TEST(FusedDepth, Benchmark) {
+    auto frame = readFrame();
+    const int iterations = 5;
+
+    stereo::DisparityEstimator full;
+    auto depthCalculator = calculator();
+    fusion::FusedDepthEstimator fused(depthCalculator);
+    cv::Mat disparity, depth;
+    auto fullMs = timeMs([&]() {
+        full.compute(frame.left, frame.right, disparity);
+        depthCalculator.compute(disparity, depth);
+    }, iterations);
+    auto fusedMs = timeMs([&]() {
+        fused.compute(frame.left, frame.right, frame.lidarDepth, boxes, depth);
+    }, iterations);
+
+    std::cout << boxes.size() << " boxes: full frame stereo " << fullMs << "ms, fused " << fusedMs
+              << "ms, disparity range reduced by " << fused.stats().rangeReduction() * 100 << "%" << std::endl;
+}
@@ -18,4 +18,27 @@ TEST(KittiUtils, ParseProjectionMatrix) {
     for (size_t i = 0; i < matrix.size(); i++) {
         ASSERT_DOUBLE_EQ(matrix[i], parsed.at<double>(i));
     }
-}
\ No newline at end of file
+}
+
+TEST(KittiUtils, OxtsPath) {
+    auto path = ivd::kitti::oxtsPath("2011_09_26/2011_09_26_drive_0001_sync/image_02/data/0000000042.png");
+    ASSERT_EQ(path, std::filesystem::path("2011_09_26/2011_09_26_drive_0001_sync/oxts/data/0000000042.txt"));
+}
+
+TEST(KittiUtils, ReadOxts) {
+    auto image = getFixturesPath() / "kitti" / "drive" / "image_02" / "data" / "0000000000.png";
+    auto oxts = ivd::kitti::readOxts(ivd::kitti::oxtsPath(image));
+
+    ASSERT_DOUBLE_EQ(oxts.values[0], 49.015003823272);
+    ASSERT_DOUBLE_EQ(oxts.values[29], 0);
+
+    auto velocity = oxts.velocity();
+    ASSERT_DOUBLE_EQ(velocity[0], 11.375145);
+    ASSERT_DOUBLE_EQ(velocity[1], -0.84253722);
+    ASSERT_DOUBLE_EQ(velocity[2], 0.18035275);
+
+    auto angular = oxts.angularVelocity();
+    ASSERT_DOUBLE_EQ(angular[0], -0.0037398451);
+    ASSERT_DOUBLE_EQ(angular[1], -0.0034219373);
+    ASSERT_DOUBLE_EQ(angular[2], -0.0091751791);
+}
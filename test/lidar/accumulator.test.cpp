@@ -0,0 +1,102 @@
+#include <test.hpp>
+
+#include <kitti/kitti_utils.hpp>
+#include <lidar/accumulator.hpp>
+#include <lidar/deskew.hpp>
+#include <lidar/lidar.hpp>
+
+#include <chrono>
+
+using namespace ivd;
+using namespace ivd::test;
+
+namespace {
+    cv::Matx44d translation(double x, double y, double z) {
+        return {1, 0, 0, x,
+                0, 1, 0, y,
+                0, 0, 1, z,
+                0, 0, 0, 1};
+    }
+}
+
+TEST(SweepAccumulator, Ring) {
+    lidar::SweepAccumulator accumulator(2, 4);
+    std::vector<float> out;
+    ASSERT_EQ(accumulator.accumulate(out), 0);
+
+    // Driving forward 1m per sweep, the same static point
+    accumulator.add({{10, 0, 0, 0.1}}, translation(0, 0, 0));
+    accumulator.add({{9, 0, 0, 0.2}}, translation(1, 0, 0));
+    ASSERT_EQ(accumulator.size(), 2);
+    ASSERT_EQ(accumulator.accumulate(out), 2);
+    ASSERT_EQ(out, (std::vector<float>{9, 0, 0, 0.2, 9, 0, 0, 0.1}));
+
+    // Oldest dropped
+    accumulator.add({{8, 0, 0, 0.3}, {0, 5, 0, 0.4}}, translation(2, 0, 0));
+    ASSERT_EQ(accumulator.size(), 2);
+    ASSERT_EQ(accumulator.points(), 3);
+    ASSERT_EQ(accumulator.accumulate(out), 3);
+    ASSERT_EQ(out, (std::vector<float>{8, 0, 0, 0.3, 0, 5, 0, 0.4, 8, 0, 0, 0.2}));
+
+    // Any frame
+    ASSERT_EQ(accumulator.accumulate(translation(0, 0, 0), out), 3);
+    ASSERT_FLOAT_EQ(out[0], 10);
+    ASSERT_FLOAT_EQ(out[4], 2);
+
+    accumulator.clear();
+    ASSERT_EQ(accumulator.accumulate(out), 0);
+}
+
+TEST(SweepAccumulator, EgoMotion) {
+    // Turning left, a static point seen from both frames ends up in the same place
+    lidar::EgoMotion motion{{10, 0, 0}, {0, 0, 0.3}};
+    auto step = motion.transform(0.1);
+    cv::Vec4d world(20, 5, 1, 1);
+    auto first = cv::Matx44d::eye();
+    auto second = first * step;
+    auto inFirst = first.inv() * world;
+    auto inSecond = second.inv() * world;
+
+    lidar::SweepAccumulator accumulator(2);
+    accumulator.add({{float(inFirst[0]), float(inFirst[1]), float(inFirst[2]), 0}}, first);
+    accumulator.add({{float(inSecond[0]), float(inSecond[1]), float(inSecond[2]), 0}}, second);
+
+    std::vector<float> out;
+    accumulator.accumulate(out);
+    for (int i = 0; i < 3; i++) {
+        ASSERT_NEAR(out[i], inSecond[i], 1e-4);
+        ASSERT_NEAR(out[4 + i], inSecond[i], 1e-4);
+    }
+}
+
+TEST(SweepAccumulator, Benchmark) {
+    auto basePath = getFixturesPath() / "lidar" / "00_basic";
+    auto points = kitti::readVeloBin(basePath / "lidar_points_raw.bin");
+    cv::Size size{1242, 375};
+    auto T = getVeloCam2Projection();
+
+    const size_t sweeps = 5;
+    lidar::SweepAccumulator accumulator(sweeps);
+    lidar::EgoMotion motion{{10, 0, 0}, {0, 0, 0.05}};
+    cv::Matx44d pose = cv::Matx44d::eye();
+
+    std::vector<float> accumulated;
+    lidar::ProjectedPoints projected;
+    size_t single = lidar::projectVelodyne(points, T, size).size();
+    const int iterations = 20;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        pose = pose * motion.transform(0.1);
+        accumulator.add(points, pose);
+        auto count = accumulator.accumulate(accumulated);
+        lidar::projectVelodyne(accumulated.data(), count, T, size, projected);
+    }
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ASSERT_EQ(accumulator.size(), sweeps);
+    ASSERT_EQ(accumulator.points(), sweeps * points.size());
+    ASSERT_GT(projected.size(), single);
+    std::cout << "Accumulate + project " << sweeps << " sweeps: " << ms / iterations << "ms, " << projected.size()
+              << " points in view (single sweep " << single << ")" << std::endl;
+}
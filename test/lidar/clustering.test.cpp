@@ -0,0 +1,101 @@
+#include <test.hpp>
+
+#include <kitti/kitti_utils.hpp>
+#include <lidar/clustering.hpp>
+#include <lidar/filters.hpp>
+
+#include <chrono>
+#include <random>
+
+using namespace ivd;
+using namespace ivd::test;
+
+namespace {
+    // Dense blob of points around center
+    void addBlob(std::vector<std::array<float, 4>> &points, cv::Point3f center, cv::Point3f extent, int count,
+                 uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> unit(-0.5, 0.5);
+        for (int i = 0; i < count; i++) {
+            points.push_back({center.x + unit(rng) * extent.x, center.y + unit(rng) * extent.y,
+                              center.z + unit(rng) * extent.z, 0});
+        }
+    }
+}
+
+TEST(Clustering, Separate) {
+    std::vector<std::array<float, 4>> points;
+    addBlob(points, {10, 2, 0}, {2, 1, 1}, 400, 1);
+    addBlob(points, {20, -3, 0}, {1, 1, 1}, 200, 2);
+    points.push_back({50, 50, 0, 0}); // Noise
+
+    // A chain of points 0.4m apart is one cluster
+    for (int i = 0; i < 20; i++) {
+        points.push_back({-10, -5 + i * 0.4f, 0, 0});
+    }
+
+    auto clusters = lidar::euclideanCluster(reinterpret_cast<float *>(points.data()), points.size());
+    ASSERT_EQ(clusters.size(), 3);
+    ASSERT_EQ(clusters[0].indices.size(), 400);
+    ASSERT_EQ(clusters[1].indices.size(), 200);
+    ASSERT_EQ(clusters[2].indices.size(), 20);
+
+    ASSERT_NEAR(clusters[0].centroid.x, 10, 0.1);
+    ASSERT_NEAR(clusters[0].centroid.y, 2, 0.1);
+    ASSERT_NEAR(clusters[0].extent().x, 2, 0.1);
+    ASSERT_NEAR(clusters[1].centroid.x, 20, 0.1);
+    ASSERT_NEAR(clusters[2].extent().y, 19 * 0.4, 1e-4);
+}
+
+TEST(Clustering, Associate) {
+    std::vector<std::array<float, 4>> points;
+    addBlob(points, {10, 2, 0}, {2, 1.5, 1.5}, 400, 1);
+    addBlob(points, {20, -3, 0}, {2, 1.5, 1.5}, 400, 2);
+    addBlob(points, {-10, 0, 0}, {2, 1.5, 1.5}, 400, 3); // Behind the camera
+    auto *raw = reinterpret_cast<float *>(points.data());
+    auto clusters = lidar::euclideanCluster(raw, points.size());
+    ASSERT_EQ(clusters.size(), 3);
+
+    // Boxes from the projected blobs
+    auto T = getVeloCam2Projection();
+    cv::Size size{1242, 375};
+    auto box = [&](size_t first, size_t count) {
+        std::vector<cv::Point> projected;
+        for (size_t i = first; i < first + count; i++) {
+            cv::Mat uvw = T * cv::Mat(cv::Vec4d(points[i][0], points[i][1], points[i][2], 1));
+            projected.emplace_back(uvw.at<double>(0) / uvw.at<double>(2), uvw.at<double>(1) / uvw.at<double>(2));
+        }
+        return cv::boundingRect(projected);
+    };
+    std::vector<cv::Rect> boxes{box(400, 400), box(0, 400), {0, 0, 20, 20}};
+
+    auto matches = lidar::associateClusters(raw, clusters, boxes, T, size);
+    ASSERT_EQ(matches.size(), 3);
+    ASSERT_GE(matches[0], 0);
+    ASSERT_GE(matches[1], 0);
+    ASSERT_NEAR(clusters[matches[0]].centroid.x, 20, 0.1);
+    ASSERT_NEAR(clusters[matches[1]].centroid.x, 10, 0.1);
+    ASSERT_EQ(matches[2], -1);
+}
+
+TEST(Clustering, Benchmark) {
+    auto basePath = getFixturesPath() / "lidar" / "00_basic";
+    auto points = lidar::removeGround(kitti::readVeloBin(basePath / "lidar_points_raw.bin"));
+    auto *raw = reinterpret_cast<const float *>(points.data());
+    const int iterations = 5;
+
+    std::vector<lidar::Cluster> clusters;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        clusters = lidar::euclideanCluster(raw, points.size());
+    }
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ASSERT_FALSE(clusters.empty());
+    size_t clustered = 0;
+    for (auto &cluster: clusters) {
+        clustered += cluster.indices.size();
+    }
+    std::cout << "Clustering " << points.size() << " points: " << ms / iterations << "ms, " << clusters.size()
+              << " clusters with " << clustered << " points" << std::endl;
+}
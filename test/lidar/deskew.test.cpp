@@ -0,0 +1,71 @@
+#include <test.hpp>
+
+#include <kitti/kitti_utils.hpp>
+#include <lidar/deskew.hpp>
+
+#include <chrono>
+
+using namespace ivd;
+using namespace ivd::test;
+
+TEST(Deskew, NoMotion) {
+    std::vector<std::array<float, 4>> points{{10, 5, 1, 0.5}, {-10, 5, 1, 0.2}};
+    auto expected = points;
+    lidar::deskew(points, {});
+    ASSERT_EQ(points, expected);
+}
+
+TEST(Deskew, Forward) {
+    // 20 m/s forward, clockwise sweep: left is measured a quarter sweep before facing forward, right after
+    std::vector<std::array<float, 4>> points{{10, 0, 0, 1}, {0, 10, 0, 1}, {0, -10, 0, 1}, {-10, 0.001, 0, 1}};
+    lidar::deskew(points, {{20, 0, 0}, {0, 0, 0}});
+
+    ASSERT_NEAR(points[0][0], 10, 1e-4);
+    ASSERT_NEAR(points[1][0], -0.5, 1e-2);
+    ASSERT_NEAR(points[2][0], 0.5, 1e-2);
+    ASSERT_NEAR(points[3][0], -10 - 1, 1e-2);
+    ASSERT_NEAR(points[1][1], 10, 1e-4);
+    ASSERT_EQ(points[1][3], 1);
+
+    // Counter clockwise flips the timing
+    std::vector<std::array<float, 4>> ccw{{0, 10, 0, 1}};
+    lidar::deskew(ccw, {{20, 0, 0}, {0, 0, 0}}, {0.1, false});
+    ASSERT_NEAR(ccw[0][0], 0.5, 1e-2);
+}
+
+TEST(Deskew, Yaw) {
+    // Turning left at 0.5 rad/s, a point to the right measured a quarter sweep later
+    std::vector<std::array<float, 4>> points{{0, -10, 0, 0}};
+    lidar::deskew(points, {{0, 0, 0}, {0, 0, 0.5}});
+    ASSERT_NEAR(points[0][0], 0.025 * 0.5 * 10, 1e-3);
+    ASSERT_NEAR(points[0][1], -10, 1e-4);
+}
+
+TEST(Deskew, FromImu) {
+    cv::Mat identity = cv::Mat::eye(4, 4, CV_64F);
+    auto motion = lidar::EgoMotion::fromImu({10, 1, 0}, {0, 0, 0.2}, identity);
+    ASSERT_EQ(motion.linear, cv::Vec3d(10, 1, 0));
+    ASSERT_EQ(motion.angular, cv::Vec3d(0, 0, 0.2));
+
+    // Velodyne 1m in front of the IMU, yawing adds a sideways velocity
+    cv::Mat T_imu_velo = cv::Mat::eye(4, 4, CV_64F);
+    T_imu_velo.at<double>(0, 3) = -1;
+    motion = lidar::EgoMotion::fromImu({10, 0, 0}, {0, 0, 0.2}, T_imu_velo);
+    ASSERT_NEAR(motion.linear[0], 10, 1e-9);
+    ASSERT_NEAR(motion.linear[1], 0.2, 1e-9);
+    ASSERT_NEAR(motion.angular[2], 0.2, 1e-9);
+}
+
+TEST(Deskew, Benchmark) {
+    auto basePath = getFixturesPath() / "lidar" / "00_basic";
+    auto points = kitti::readVeloBin(basePath / "lidar_points_raw.bin");
+    lidar::EgoMotion motion{{15, 0, 0}, {0, 0, 0.1}};
+    const int iterations = 10;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        lidar::deskew(points, motion);
+    }
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Deskew " << points.size() << " points: " << ms / iterations << "ms" << std::endl;
+}
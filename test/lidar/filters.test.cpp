@@ -0,0 +1,80 @@
+#include <test.hpp>
+
+#include <kitti/kitti_utils.hpp>
+#include <lidar/filters.hpp>
+#include <lidar/lidar.hpp>
+
+#include <chrono>
+
+using namespace ivd;
+using namespace ivd::test;
+
+TEST(Filters, VoxelDownsample) {
+    std::vector<std::array<float, 4>> points{
+            {0.1, 0.1, 0.1, 0.2},
+            {0.3, 0.3, 0.3, 0.4}, // Same voxel as the first
+            {-0.1, 0.1, 0.1, 1},
+            {5, 5, 5, 0.5},
+    };
+    auto result = lidar::voxelDownsample(points, 0.5);
+    ASSERT_EQ(result.size(), 3);
+
+    auto merged = std::find_if(result.begin(), result.end(), [](auto &p) { return p[3] > 0.25 && p[3] < 0.35; });
+    ASSERT_NE(merged, result.end());
+    ASSERT_FLOAT_EQ((*merged)[0], 0.2);
+    ASSERT_FLOAT_EQ((*merged)[1], 0.2);
+    ASSERT_FLOAT_EQ((*merged)[2], 0.2);
+
+    ASSERT_TRUE(lidar::voxelDownsample({}, 0.5).empty());
+}
+
+TEST(Filters, RemoveGround) {
+    std::vector<std::array<float, 4>> points{
+            {10, 0, -1.73, 0}, // Road
+            {10.1, 0.1, -1.6, 0}, // Road, a bit higher
+            {10.2, 0.2, -0.5, 0}, // Car on the road
+            {20, 0, 0, 0}, // Cell without ground
+            {200, 0, -1.73, 0}, // Out of the grid
+    };
+    auto result = lidar::removeGround(points);
+    ASSERT_EQ(result.size(), 3);
+    ASSERT_FLOAT_EQ(result[0][2], -0.5);
+    ASSERT_FLOAT_EQ(result[1][0], 20);
+    ASSERT_FLOAT_EQ(result[2][0], 200);
+}
+
+TEST(Filters, Benchmark) {
+    auto basePath = getFixturesPath() / "lidar" / "00_basic";
+    auto points = kitti::readVeloBin(basePath / "lidar_points_raw.bin");
+    cv::Size size{1242, 375};
+    auto T = getVeloCam2Projection();
+    const int iterations = 10;
+    auto *raw = reinterpret_cast<const float *>(points.data());
+
+    std::vector<float> downsampled, filtered;
+    size_t downsampledCount = 0, filteredCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        downsampledCount = lidar::voxelDownsample(raw, points.size(), 0.2, downsampled);
+    }
+    auto voxelMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        filteredCount = lidar::removeGround(downsampled.data(), downsampledCount, {}, filtered);
+    }
+    auto groundMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ASSERT_LT(downsampledCount, points.size());
+    ASSERT_LT(filteredCount, downsampledCount);
+
+    auto all = lidar::projectVelodyne(points, T, size).size();
+    lidar::ProjectedPoints projected;
+    lidar::projectVelodyne(filtered.data(), filteredCount, T, size, projected);
+
+    std::cout << "Voxel downsample " << points.size() << " -> " << downsampledCount << " points: "
+              << voxelMs / iterations << "ms" << std::endl;
+    std::cout << "Remove ground " << downsampledCount << " -> " << filteredCount << " points: "
+              << groundMs / iterations << "ms" << std::endl;
+    std::cout << "In view " << all << " -> " << projected.size() << " points" << std::endl;
+}
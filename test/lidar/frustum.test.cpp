@@ -0,0 +1,111 @@
+#include <test.hpp>
+
+#include <kitti/kitti_utils.hpp>
+#include <lidar/frustum.hpp>
+#include <lidar/lidar.hpp>
+
+#include <chrono>
+#include <random>
+
+using namespace ivd;
+using namespace ivd::test;
+
+TEST(Frustum, MatchesProjection) {
+    cv::Size size{1242, 375};
+    auto T = getVeloCam2Projection();
+    lidar::FrustumCuller culler(T, size);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coordinate(-80, 80);
+    size_t inView = 0;
+    for (int i = 0; i < 10000; i++) {
+        cv::Vec4d p(coordinate(rng), coordinate(rng), coordinate(rng) / 20, 1);
+        cv::Mat uvw = T * cv::Mat(p);
+        auto w = uvw.at<double>(2);
+        auto u = uvw.at<double>(0) / w;
+        auto v = uvw.at<double>(1) / w;
+        bool expected = w > 0 && u > 0 && u < size.width && v > 0 && v < size.height;
+        ASSERT_EQ(culler.contains(float(p[0]), float(p[1]), float(p[2])), expected) << p;
+        inView += expected;
+    }
+    ASSERT_GT(inView, 0);
+}
+
+TEST(Frustum, Cull) {
+    auto basePath = getFixturesPath() / "lidar" / "00_basic";
+    auto points = kitti::readVeloBin(basePath / "lidar_points_raw.bin");
+    cv::Size size{1242, 375};
+    auto T = getVeloCam2Projection();
+    lidar::FrustumCuller culler(T, size);
+
+    std::vector<float> raw;
+    auto count = culler.cull(points.front().data(), points.size(), raw);
+    ASSERT_EQ(raw.size(), count * 4);
+
+    cv::Mat data(points.size(), 4, CV_32F, points.data());
+    auto culled = culler.cull(data);
+    ASSERT_EQ(culled.rows, count);
+    ASSERT_EQ(culled.cols, 4);
+
+    // Everything left projects into the image
+    auto projected = lidar::projectVelodyne(raw.data(), count, T, size);
+    ASSERT_NEAR(double(projected.size()), double(count), count * 0.001);
+    std::cout << "In view: " << count << " of " << points.size() << " points" << std::endl;
+}
+
+TEST(Frustum, ProjectBounds) {
+    // u = x / z, v = y / z
+    cv::Mat T = (cv::Mat_<double>(3, 4) << 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0);
+    cv::Mat homogeneous = (cv::Mat_<double>(6, 4) <<
+            5, 5, 1, 1,    // Inside
+            0, 5, 1, 1,    // u == 0
+            10, 5, 1, 1,   // u == width
+            5, 0, 1, 1,    // v == 0
+            5, 10, 1, 1,   // v == height
+            -5, -5, -1, 1  // Behind the camera, projects to (5, 5)
+    );
+
+    // Without a size every point is projected
+    ASSERT_EQ(lidar::project(homogeneous, T).cols, 6);
+
+    // With a size only the points strictly inside the image and in front of the camera
+    auto result = lidar::project(homogeneous, T, {10, 10});
+    ASSERT_EQ(result.cols, 1);
+    ASSERT_DOUBLE_EQ(result.at<double>(0, 0), 5);
+    ASSERT_DOUBLE_EQ(result.at<double>(1, 0), 5);
+    ASSERT_DOUBLE_EQ(result.at<double>(2, 0), 1);
+}
+
+TEST(Frustum, Benchmark) {
+    auto basePath = getFixturesPath() / "lidar" / "00_basic";
+    auto points = kitti::readVeloBin(basePath / "lidar_points_raw.bin");
+    cv::Size size{1242, 375};
+    auto T = getVeloCam2Projection();
+    cv::Mat data(points.size(), 4, CV_32F, points.data());
+    auto homogeneous = lidar::makeHomogeneous(data.colRange(0, 3));
+    const int iterations = 10;
+
+    // Projecting everything, then dropping what is out of view
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        cv::Mat all = lidar::project(homogeneous, T);
+        ASSERT_EQ(all.cols, homogeneous.rows);
+    }
+    auto fullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Culled before projecting
+    cv::Mat culled;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        culled = lidar::project(homogeneous, T, size);
+    }
+    auto culledMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Project " << homogeneous.rows << " points: all " << fullMs / iterations << "ms, frustum culled "
+              << culledMs / iterations << "ms (" << culled.cols << " in view)" << std::endl;
+
+    // No points behind the camera
+    for (int i = 0; i < culled.cols; i++) {
+        ASSERT_GT(culled.at<double>(2, i), 0);
+    }
+}
@@ -1,12 +1,17 @@
 #include <test.hpp>
 
+#include <common/depth_format.hpp>
 #include <common/opencv_utils.hpp>
 #include <kitti/kitti_utils.hpp>
 #include <lidar/lidar.hpp>
+#include <lidar/sparse_depth.hpp>
 #include <lidar/visualize.hpp>
 
 #include <npy.hpp>
 
+#include <chrono>
+#include <random>
+
 using namespace ivd;
 using namespace ivd::test;
 
@@ -165,4 +170,205 @@ TEST(Lidar, GetDepth) {
     auto depth = lidar::getDepth(depthMap, bbox);
     ASSERT_TRUE(depth.has_value());
     ASSERT_NEAR(*depth, 8.24, 0.01);
-}
\ No newline at end of file
+}
+
+TEST(Lidar, ProjectVelodyne) {
+    std::vector<std::array<float, 4>> points{
+            {78.37, 10.449, 2.883, 0},
+            {74.894, 10.464, 2.766, 0},
+            {-10, 0, 0, 0}, // Behind the camera
+            {78.37, -1000, 2.883, 0}, // Outside of the image
+    };
+    auto T = getVeloCam2Projection();
+
+    auto result = lidar::projectVelodyne(points, T, {1242, 375});
+    ASSERT_EQ(result.size(), 2);
+    ASSERT_NEAR(result.u[0], 514.03340, 0.01);
+    ASSERT_NEAR(result.v[0], 154.11202, 0.01);
+    ASSERT_NEAR(result.z[0], 78.13051, 0.01);
+    ASSERT_NEAR(result.u[1], 509.44331, 0.01);
+    ASSERT_NEAR(result.v[1], 154.02027, 0.01);
+    ASSERT_NEAR(result.z[1], 74.65348, 0.01);
+
+    auto mat = result.toMat();
+    ASSERT_EQ(mat.size(), cv::Size(2, 3));
+    ASSERT_EQ(mat.type(), CV_64F);
+    ASSERT_FLOAT_EQ(float(mat.at<double>(2, 1)), result.z[1]);
+}
+
+TEST(Lidar, ProjectVelodyne_Benchmark) {
+    auto basePath = getFixturesPath() / "lidar" / "00_basic";
+    auto points = kitti::readVeloBin(basePath / "lidar_points_raw.bin");
+    cv::Size size{1242, 375};
+    auto T = getVeloCam2Projection();
+    const int iterations = 10;
+
+    cv::Mat reference;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        cv::Mat data(points.size(), 4, CV_32F, points.data());
+        reference = lidar::project(lidar::makeHomogeneous(data.colRange(0, 3)), T, size);
+    }
+    auto referenceMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    lidar::ProjectedPoints projected;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        lidar::projectVelodyne(points.front().data(), points.size(), T, size, projected);
+    }
+    auto fusedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Projecting " << points.size() << " points: makeHomogeneous + project " << referenceMs / iterations
+              << "ms, projectVelodyne " << fusedMs / iterations << "ms" << std::endl;
+
+    // Same points, minus the ones behind the camera the reference keeps, up to rounding at the image edges
+    size_t expected = 0;
+    for (int i = 0; i < reference.cols; i++) {
+        expected += reference.at<double>(2, i) > 0;
+    }
+    ASSERT_NEAR(double(projected.size()), double(expected), expected * 0.001);
+    ASSERT_GT(projected.size(), 0);
+}
+
+TEST(Lidar, DepthMapZBuffer) {
+    lidar::ProjectedPoints points;
+    points.u = {5.2, 5.7, 2};
+    points.v = {5.1, 5.9, 8};
+    points.z = {10, 30, 20}; // Background point last
+
+    auto lastWins = lidar::depthMapFromProjectedPoints(points.toMat(), {10, 10});
+    ASSERT_EQ(lastWins.at<double>(5, 5), 30);
+
+    for (bool parallel: {false, true}) {
+        auto nearest = lidar::depthMapFromProjectedPoints(points, {10, 10}, {0, parallel});
+        ASSERT_EQ(nearest.type(), CV_64F);
+        ASSERT_EQ(nearest.at<double>(5, 5), 10);
+        ASSERT_EQ(nearest.at<double>(8, 2), 20);
+        ASSERT_EQ(cv::countNonZero(nearest), 2);
+
+        // Splats overlap at (3..4, 6..7), nearest wins
+        auto splatted = lidar::depthMapFromProjectedPoints(points, {10, 10}, {2, parallel});
+        ASSERT_EQ(cv::countNonZero(splatted), 25 + 20 - 4);
+        ASSERT_EQ(splatted.at<double>(7, 3), 10);
+        ASSERT_EQ(splatted.at<double>(9, 0), 20);
+        ASSERT_EQ(splatted.at<double>(3, 3), 10);
+    }
+}
+
+TEST(Lidar, DepthMapZBuffer_Parallel) {
+    auto basePath = getFixturesPath() / "lidar" / "00_basic";
+    auto raw = kitti::readVeloBin(basePath / "lidar_points_raw.bin");
+    cv::Size size{1242, 375};
+    auto T = getVeloCam2Projection();
+    auto points = lidar::projectVelodyne(raw, T, size);
+    auto mat = points.toMat();
+    const int iterations = 10;
+
+    for (int radius: {0, 1, 2}) {
+        cv::Mat serial, parallel;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            serial = lidar::depthMapFromProjectedPoints(points, size, {radius, false});
+        }
+        auto serialMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            parallel = lidar::depthMapFromProjectedPoints(points, size, {radius, true});
+        }
+        auto parallelMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        ASSERT_EQ(cv::norm(serial, parallel, cv::NORM_INF), 0) << radius;
+        std::cout << "Z-buffer radius " << radius << ": serial " << serialMs / iterations << "ms, parallel "
+                  << parallelMs / iterations << "ms" << std::endl;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        lidar::depthMapFromProjectedPoints(mat, size);
+    }
+    auto lastWinsMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Last point wins: " << lastWinsMs / iterations << "ms" << std::endl;
+
+    // Same pixels as last point wins, never deeper
+    auto zBuffer = lidar::depthMapFromProjectedPoints(points, size);
+    auto lastWins = lidar::depthMapFromProjectedPoints(mat, size);
+    ASSERT_EQ(cv::countNonZero(zBuffer), cv::countNonZero(lastWins));
+    ASSERT_EQ(cv::countNonZero(zBuffer > lastWins), 0);
+
+    // Sparse map keeping the nearest point agrees
+    lidar::SparseDepthMap sparse(points, size, lidar::SparseDepthMap::Keep::Nearest);
+    ASSERT_EQ(cv::norm(zBuffer, sparse.toDense(), cv::NORM_INF), 0);
+}
+
+TEST(Lidar, GetDepth_Compact) {
+    auto basePath = getFixturesPath() / "lidar" / "00_basic";
+    auto image = cv::imread(basePath / "left.png");
+    auto npydata = npy::read_npy<double>(basePath / "lidar_points_cam.npy");
+    cv::Mat points(cv::Size(npydata.shape[0], npydata.shape[1]), CV_64F, npydata.data.data());
+    auto depthMap = lidar::depthMapFromProjectedPoints(points, image.size());
+
+    cv::Rect bbox{255, 165, 256, 183};
+    cv::Mat mask(bbox.size(), CV_8U, cv::Scalar(0));
+    cv::circle(mask, {128, 90}, 80, cv::Scalar(255), -1);
+    for (auto &m: {cv::Mat(), mask}) {
+        auto expected = lidar::getDepth(depthMap, bbox, m);
+        ASSERT_TRUE(expected.has_value());
+
+        // Within the format's resolution
+        ASSERT_NEAR(*lidar::getDepth(common::convertDepth(depthMap, CV_32F), bbox, m), *expected, 1e-5);
+        ASSERT_NEAR(*lidar::getDepth(common::convertDepth(depthMap, CV_16U), bbox, m), *expected,
+                    0.5 / common::depthScale16U);
+        ASSERT_NEAR(*lidar::getDepth(common::convertDepth(depthMap, CV_16F), bbox, m), *expected,
+                    *expected / 1024);
+    }
+}
+
+TEST(Lidar, GetDepth_Compact_Benchmark) {
+    auto basePath = getFixturesPath() / "lidar" / "00_basic";
+    auto image = cv::imread(basePath / "left.png");
+    auto npydata = npy::read_npy<double>(basePath / "lidar_points_cam.npy");
+    cv::Mat points(cv::Size(npydata.shape[0], npydata.shape[1]), CV_64F, npydata.data.data());
+    auto depthMap = lidar::depthMapFromProjectedPoints(points, image.size());
+
+    // Detections of a dense scene
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> x(0, image.cols - 200);
+    std::uniform_int_distribution<int> y(100, image.rows - 120);
+    std::uniform_int_distribution<int> size(30, 120);
+    std::vector<cv::Rect> boxes;
+    for (int i = 0; i < 40; i++) {
+        boxes.emplace_back(x(rng), y(rng), size(rng) + 60, size(rng));
+    }
+    const int iterations = 50;
+
+    for (auto type: {CV_64F, CV_32F, CV_16F, CV_16U}) {
+        cv::Mat converted;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            common::convertDepth(depthMap, converted, type);
+        }
+        auto convertMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        double sum = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            for (auto &box: boxes) {
+                sum += lidar::getDepth(converted, box).value_or(0);
+            }
+        }
+        auto queryMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // Bytes and cache lines (64 bytes) a frame of queries reads
+        size_t bytes = 0;
+        size_t lines = 0;
+        for (auto &box: boxes) {
+            bytes += box.area() * converted.elemSize();
+            lines += box.height * ((box.width * converted.elemSize() + 63) / 64 + 1);
+        }
+        std::cout << "Depth map " << cv::typeToString(type) << ": " << converted.total() * converted.elemSize() / 1024
+                  << "KiB, convert " << convertMs / iterations << "ms, " << boxes.size() << " queries "
+                  << queryMs / iterations << "ms reading " << bytes / 1024 << "KiB in <= " << lines
+                  << " cache lines (sum " << sum / iterations << ")" << std::endl;
+    }
+}
@@ -0,0 +1,172 @@
+#include <test.hpp>
+
+#include <kitti/kitti_utils.hpp>
+#include <lidar/lidar.hpp>
+#include <lidar/sparse_depth.hpp>
+
+using namespace ivd;
+using namespace ivd::test;
+
+namespace {
+    lidar::ProjectedPoints projectFixture(const cv::Size &size) {
+        auto basePath = getFixturesPath() / "lidar" / "00_basic";
+        auto points = kitti::readVeloBin(basePath / "lidar_points_raw.bin");
+        auto T = getVeloCam2Projection();
+        return lidar::projectVelodyne(points, T, size);
+    }
+
+    std::vector<cv::Rect> queryBoxes(const cv::Size &size) {
+        std::vector<cv::Rect> boxes{{255, 165, 256, 183}, {0, 0, size.width, size.height}, {600, 10, 1, 1}};
+        for (int y = 0; y + 120 <= size.height; y += 60) {
+            for (int x = 0; x + 200 <= size.width; x += 150) {
+                boxes.emplace_back(x, y, 200, 120);
+            }
+        }
+        return boxes;
+    }
+}
+
+TEST(SparseDepth, Duplicates) {
+    lidar::ProjectedPoints points;
+    points.u = {1.2, 1.7, 3, 0.5};
+    points.v = {2.1, 2.9, 2, 0};
+    points.z = {10, 5, 7, 1};
+
+    lidar::SparseDepthMap map(points, {4, 4});
+    ASSERT_EQ(map.count(), 3);
+
+    // Last point for (1, 2) wins, like the dense map
+    auto dense = map.toDense();
+    ASSERT_EQ(dense.at<double>(2, 1), 5);
+    ASSERT_EQ(dense.at<double>(2, 3), 7);
+    ASSERT_EQ(dense.at<double>(0, 0), 1);
+    ASSERT_EQ(cv::countNonZero(dense), 3);
+    ASSERT_EQ(cv::norm(dense, lidar::depthMapFromProjectedPoints(points.toMat(), {4, 4}), cv::NORM_INF), 0);
+
+    ASSERT_FALSE(map.getDepth({0, 3, 4, 1}).has_value());
+    ASSERT_EQ(*map.getDepth({1, 2, 3, 1}), 7);
+}
+
+TEST(SparseDepth, MatchesDense) {
+    cv::Size size{1242, 375};
+    auto projected = projectFixture(size);
+    auto dense = lidar::depthMapFromProjectedPoints(projected.toMat(), size);
+    lidar::SparseDepthMap sparse(projected, size);
+
+    ASSERT_EQ(sparse.count(), size_t(cv::countNonZero(dense)));
+    ASSERT_EQ(cv::norm(dense, sparse.toDense(), cv::NORM_INF), 0);
+
+    for (auto &bbox: queryBoxes(size)) {
+        ASSERT_EQ(sparse.getDepth(bbox), lidar::getDepth(dense, bbox)) << bbox;
+
+        cv::Mat mask(bbox.size(), CV_8U, cv::Scalar(0));
+        cv::ellipse(mask, {bbox.width / 2, bbox.height / 2}, {bbox.width / 3, bbox.height / 2}, 0, 0, 360,
+                    cv::Scalar(255), -1);
+        ASSERT_EQ(sparse.getDepth(bbox, mask), lidar::getDepth(dense, bbox, mask)) << bbox;
+    }
+}
+
+TEST(SparseDepth, Benchmark) {
+    cv::Size size{1242, 375};
+    auto projected = projectFixture(size);
+    auto points = projected.toMat();
+    auto boxes = queryBoxes(size);
+
+    cv::Mat dense;
+    lidar::SparseDepthMap sparse;
+    auto denseBuildMs = timeMs([&]() { dense = lidar::depthMapFromProjectedPoints(points, size); });
+    auto sparseBuildMs = timeMs([&]() { sparse.assign(projected, size); });
+
+    std::vector<cv::Mat> masks;
+    for (auto &bbox: boxes) {
+        masks.emplace_back(bbox.size(), CV_8U, cv::Scalar(255));
+    }
+
+    auto denseQueryMs = timeMs([&]() {
+        for (auto &bbox: boxes) {
+            lidar::getDepth(dense, bbox);
+        }
+    });
+    auto sparseQueryMs = timeMs([&]() {
+        for (auto &bbox: boxes) {
+            sparse.getDepth(bbox);
+        }
+    });
+    auto denseMaskedMs = timeMs([&]() {
+        for (size_t i = 0; i < boxes.size(); i++) {
+            lidar::getDepth(dense, boxes[i], masks[i]);
+        }
+    });
+    auto sparseMaskedMs = timeMs([&]() {
+        for (size_t i = 0; i < boxes.size(); i++) {
+            sparse.getDepth(boxes[i], masks[i]);
+        }
+    });
+
+    std::cout << projected.size() << " points, " << sparse.count() << " pixels with depth" << std::endl;
+    std::cout << "Build: dense " << denseBuildMs << "ms, sparse " << sparseBuildMs << "ms" << std::endl;
+    std::cout << boxes.size() << " box queries: dense " << denseQueryMs << "ms, sparse " << sparseQueryMs
+              << "ms" << std::endl;
+    std::cout << boxes.size() << " masked queries: dense " << denseMaskedMs << "ms, sparse " << sparseMaskedMs
+              << "ms" << std::endl;
+}
+
+TEST(SparseDepth, GetDepths) {
+    cv::Size size{1242, 375};
+    auto projected = projectFixture(size);
+    auto boxes = queryBoxes(size);
+    lidar::SparseDepthMap sparse(projected, size);
+    auto dense = sparse.toDense();
+
+    std::vector<cv::Mat> masks;
+    for (size_t i = 0; i < boxes.size(); i++) {
+        // Every other box without a mask
+        masks.emplace_back(i % 2 ? cv::Mat() : cv::Mat(boxes[i].size(), CV_8U, cv::Scalar(0)));
+        if (!masks.back().empty()) {
+            cv::circle(masks.back(), {boxes[i].width / 2, boxes[i].height / 2}, boxes[i].height / 2,
+                       cv::Scalar(255), -1);
+        }
+    }
+
+    // Same as one by one, in order
+    auto batched = sparse.getDepths(boxes, masks);
+    auto batchedDense = lidar::getDepths(dense, boxes, masks);
+    ASSERT_EQ(batched.size(), boxes.size());
+    ASSERT_EQ(batchedDense.size(), boxes.size());
+    for (size_t i = 0; i < boxes.size(); i++) {
+        ASSERT_EQ(batched[i], sparse.getDepth(boxes[i], masks[i])) << boxes[i];
+        ASSERT_EQ(batchedDense[i], lidar::getDepth(dense, boxes[i], masks[i])) << boxes[i];
+    }
+
+    // Without masks
+    auto unmasked = sparse.getDepths(boxes);
+    for (size_t i = 0; i < boxes.size(); i++) {
+        ASSERT_EQ(unmasked[i], sparse.getDepth(boxes[i])) << boxes[i];
+    }
+    ASSERT_TRUE(sparse.getDepths({}).empty());
+}
+
+TEST(SparseDepth, GetDepths_Benchmark) {
+    cv::Size size{1242, 375};
+    auto projected = projectFixture(size);
+    auto boxes = queryBoxes(size);
+    lidar::SparseDepthMap sparse(projected, size);
+    auto dense = sparse.toDense();
+
+    auto serialMs = timeMs([&]() {
+        for (auto &bbox: boxes) {
+            lidar::getDepth(dense, bbox);
+        }
+    });
+    auto batchedMs = timeMs([&]() { lidar::getDepths(dense, boxes); });
+    auto sparseSerialMs = timeMs([&]() {
+        for (auto &bbox: boxes) {
+            sparse.getDepth(bbox);
+        }
+    });
+    auto sparseBatchedMs = timeMs([&]() { sparse.getDepths(boxes); });
+
+    std::cout << boxes.size() << " box queries on " << cv::getNumThreads() << " threads: dense serial "
+              << serialMs << "ms, batched " << batchedMs << "ms, sparse serial " << sparseSerialMs
+              << "ms, batched " << sparseBatchedMs << "ms" << std::endl;
+}
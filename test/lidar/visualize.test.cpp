@@ -0,0 +1,106 @@
+#include <test.hpp>
+
+#include <kitti/kitti_utils.hpp>
+#include <lidar/lidar.hpp>
+#include <lidar/visualize.hpp>
+
+#include <chrono>
+
+using namespace ivd;
+using namespace ivd::test;
+
+TEST(Visualize, RenderLidarPoints) {
+    lidar::ProjectedPoints points;
+    points.u = {10.5, 50, 0, 99.9};
+    points.v = {10.2, 20, 0, 49.9};
+    points.z = {5, 25, 45, 49};
+
+    // Same colors as the slow path, up to the LUT resolution
+    cv::Mat expected(50, 100, CV_8UC3, cv::Scalar(0));
+    lidar::visualizeLidarPoints(expected, points.toMat());
+    cv::Mat image(50, 100, CV_8UC3, cv::Scalar(0));
+    lidar::renderLidarPoints(image, points);
+
+    for (size_t i = 0; i < points.size(); i++) {
+        cv::Point p(int(points.u[i]), int(points.v[i]));
+        auto diff = cv::norm(cv::Vec3d(image.at<cv::Vec3b>(p)) - cv::Vec3d(expected.at<cv::Vec3b>(p)), cv::NORM_INF);
+        ASSERT_LE(diff, 8) << p;
+    }
+
+    // Crosses, clipped at the borders
+    ASSERT_EQ(cv::countNonZero(image.reshape(1, image.rows * image.cols).col(0) +
+                               image.reshape(1, image.rows * image.cols).col(1) +
+                               image.reshape(1, image.rows * image.cols).col(2)), 5 + 5 + 3 + 3);
+}
+
+TEST(Visualize, DepthForBBox) {
+    cv::Mat depthMap(50, 100, CV_64F, cv::Scalar(0));
+    depthMap.at<double>(10, 10) = 5;
+    depthMap.at<double>(20, 30) = 10;
+    depthMap.at<double>(40, 80) = 10; // Outside of the box
+    cv::Rect bbox{0, 0, 50, 30};
+    cv::Mat mask(bbox.size(), CV_8U, cv::Scalar(255));
+    mask.at<uchar>(20, 30) = 0;
+
+    cv::Mat image(50, 100, CV_8UC3, cv::Scalar(0));
+    lidar::visualizeLidarDepthForBBox(image, depthMap, bbox);
+    cv::Mat gray;
+    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    ASSERT_EQ(cv::countNonZero(gray), 10);
+
+    image.setTo(0);
+    lidar::visualizeLidarDepthForBBox(image, depthMap, bbox, mask);
+    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    ASSERT_EQ(cv::countNonZero(gray), 5);
+    ASSERT_NE(gray.at<uchar>(9, 10), 0);
+
+    // Boxes reaching past the image are clipped, with their mask
+    cv::Rect outside{-20, -10, 60, 50};
+    cv::Mat outsideMask(outside.size(), CV_8U, cv::Scalar(255));
+    outsideMask.at<uchar>(20 + 10, 30 + 20) = 0;
+    image.setTo(0);
+    lidar::visualizeLidarDepthForBBox(image, depthMap, outside, outsideMask);
+    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    ASSERT_EQ(cv::countNonZero(gray), 5);
+
+    image.setTo(0);
+    lidar::visualizeLidarDepthForBBox(image, depthMap, {200, 0, 10, 10});
+    ASSERT_EQ(cv::countNonZero(image.reshape(1)), 0);
+}
+
+TEST(Visualize, Benchmark) {
+    auto basePath = getFixturesPath() / "lidar" / "00_basic";
+    auto raw = kitti::readVeloBin(basePath / "lidar_points_raw.bin");
+    auto image = cv::imread(basePath / "left.png");
+    auto T = getVeloCam2Projection();
+    auto points = lidar::projectVelodyne(raw, T, image.size());
+    auto mat = points.toMat();
+    const int iterations = 10;
+
+    cv::Mat slow, fast;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        slow = image.clone();
+        lidar::visualizeLidarPoints(slow, mat);
+    }
+    auto slowMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        fast = image.clone();
+        lidar::renderLidarPoints(fast, points);
+    }
+    auto fastMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    cv::imwrite(basePath / "RenderLidarPoints_out.png", fast);
+
+    std::cout << "Render " << points.size() << " points: visualizeLidarPoints " << slowMs / iterations
+              << "ms, renderLidarPoints " << fastMs / iterations << "ms" << std::endl;
+
+    // Visually the same
+    const float threshold = 0.1;
+    auto diff = fast.clone();
+    auto mismatched = pixelmatch(fast.data, fast.channels() * fast.size().width, slow.data,
+                                 slow.channels() * slow.size().width, fast.size().width, fast.size().height,
+                                 diff.data, threshold);
+    EXPECT_LT(mismatched, fast.total() * 0.05);
+}
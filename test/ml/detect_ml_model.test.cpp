@@ -99,6 +99,60 @@ TEST(DetectMLModel, loadYoloSeg) {
     ASSERT_EQ(model.outputNodes().size(), 2);
 }
 
+TEST(DetectMLModel, loadYoloRectangular) {
+    auto modelPath = getModelsPath() / "yolo" / "yolov8n-640x192.onnx";
+    if (!exists(modelPath)) {
+        GTEST_SKIP() << "Rectangular model not exported: " << modelPath;
+    }
+    ivd::ml::DetectMLModel model{modelPath};
+    ASSERT_EQ(model.inputSize().width, 640);
+    ASSERT_EQ(model.inputSize().height, 192);
+
+    cv::Mat image = cv::imread(getFixturesPath() / "ml" / "yolov8" / "image00" / "image.png");
+    auto detections = model.predict(image);
+    ASSERT_FALSE(detections.empty());
+}
+
+TEST(DetectMLModel, Tiles) {
+    cv::Size imageSize{1242, 375};
+    auto tiles = ivd::ml::DetectMLModel::tiles(imageSize, {3, 1, 0.2});
+    ASSERT_EQ(tiles.size(), 3);
+
+    // Covers the whole image with overlap
+    ASSERT_EQ(tiles.front().x, 0);
+    ASSERT_EQ(tiles.back().br().x, imageSize.width);
+    for (size_t i = 0; i < tiles.size(); i++) {
+        ASSERT_EQ(tiles[i].y, 0);
+        ASSERT_EQ(tiles[i].height, imageSize.height);
+        ASSERT_EQ(tiles[i] & cv::Rect({}, imageSize), tiles[i]);
+        if (i > 0) {
+            ASSERT_GT(tiles[i - 1].br().x, tiles[i].x);
+        }
+    }
+
+    // No tiling
+    auto single = ivd::ml::DetectMLModel::tiles(imageSize, {1, 1, 0.2});
+    ASSERT_EQ(single.size(), 1);
+    ASSERT_EQ(single[0], cv::Rect({}, imageSize));
+}
+
+TEST(DetectMLModel, PredictTiled) {
+    ivd::ml::DetectMLModel model{getModelsPath() / "yolo" / "yolov8n-seg.onnx"};
+    cv::Mat image = cv::imread(getFixturesPath() / "ml" / "yolov8-seg" / "image00" / "image.png");
+
+    auto detections = model.predictTiled(image);
+    ASSERT_FALSE(detections.empty());
+    for (auto &detection: detections) {
+        cv::Rect box = detection.bbox;
+        ASSERT_EQ(box & cv::Rect({}, image.size()), box);
+        ASSERT_EQ(detection.mask.size(), box.size());
+    }
+
+    overlaySegmentationMasks(image, detections);
+    overlayDetections(image, detections);
+    cv::imwrite(getFixturesPath() / "ml" / "yolov8-seg" / "image00" / "tiled_output.png", image);
+}
+
 // Parameterized tests
 
 TEST_P(YoloDetect, Predict) {
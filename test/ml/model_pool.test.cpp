@@ -0,0 +1,111 @@
+#include <test.hpp>
+
+#include <ml/detect_ml_model.hpp>
+#include <ml/model_pool.hpp>
+
+#include <atomic>
+#include <thread>
+
+using namespace ivd::test;
+
+namespace {
+    struct DummyModel {
+        int id;
+    };
+}
+
+TEST(ModelPool, BoundedCapacity) {
+    int created = 0;
+    ivd::ml::ModelPool<DummyModel> pool(2, [&]() { return std::make_unique<DummyModel>(DummyModel{created++}); });
+    ASSERT_EQ(pool.capacity(), 2);
+    ASSERT_EQ(pool.size(), 0);
+
+    {
+        auto first = pool.acquire();
+        auto second = pool.tryAcquire();
+        ASSERT_TRUE(second.has_value());
+        ASSERT_NE(first->id, (*second)->id);
+        ASSERT_EQ(pool.size(), 2);
+
+        // Exhausted
+        ASSERT_FALSE(pool.tryAcquire().has_value());
+    }
+
+    // Returned, not re-created
+    ASSERT_EQ(pool.idle(), 2);
+    auto third = pool.acquire();
+    ASSERT_EQ(created, 2);
+}
+
+TEST(ModelPool, AcquireBlocksUntilReleased) {
+    ivd::ml::ModelPool<DummyModel> pool(1, []() { return std::make_unique<DummyModel>(DummyModel{0}); });
+    auto lease = std::make_unique<ivd::ml::ModelPool<DummyModel>::Lease>(pool.acquire());
+
+    std::atomic<bool> acquired{false};
+    std::thread waiter([&]() {
+        auto other = pool.acquire();
+        acquired = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_FALSE(acquired);
+    lease.reset();
+    waiter.join();
+    ASSERT_TRUE(acquired);
+    ASSERT_EQ(pool.size(), 1);
+}
+
+TEST(ModelPool, ConcurrentPredict) {
+    auto modelPath = getModelsPath() / "yolo" / "yolov8n.onnx";
+    auto fixturesDir = getFixturesPath() / "ml" / "yolov8";
+    std::vector<cv::Mat> images{cv::imread(fixturesDir / "image00" / "image.png"),
+                                cv::imread(fixturesDir / "image01" / "image.png"),
+                                cv::imread(fixturesDir / "image02" / "image.png")};
+
+    // Single threaded baseline
+    std::vector<std::vector<ivd::ml::Detection>> expected;
+    {
+        ivd::ml::DetectMLModel model{modelPath};
+        for (auto &image: images) {
+            expected.push_back(model.predict(image));
+            ASSERT_FALSE(expected.back().empty());
+        }
+    }
+
+    const size_t capacity = 3;
+    const size_t threads = 8;
+    const size_t iterations = 5;
+    ivd::ml::ModelPool<ivd::ml::DetectMLModel> pool(capacity, ivd::ml::modelFactory<ivd::ml::DetectMLModel>(modelPath));
+
+    std::atomic<size_t> mismatches{0};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            for (size_t i = 0; i < iterations; i++) {
+                auto imageIdx = (t + i) % images.size();
+                auto model = pool.acquire();
+                auto detections = model->predict(images[imageIdx]);
+
+                auto &reference = expected[imageIdx];
+                if (detections.size() != reference.size()) {
+                    mismatches++;
+                    continue;
+                }
+                for (size_t d = 0; d < detections.size(); d++) {
+                    if (detections[d].classIndex != reference[d].classIndex ||
+                        detections[d].bbox != reference[d].bbox) {
+                        mismatches++;
+                    }
+                }
+            }
+        });
+    }
+
+    for (auto &worker: workers) {
+        worker.join();
+    }
+
+    ASSERT_EQ(mismatches, 0);
+    ASSERT_LE(pool.size(), capacity);
+    ASSERT_EQ(pool.idle(), pool.size());
+}
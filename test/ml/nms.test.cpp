@@ -0,0 +1,155 @@
+#include <test.hpp>
+
+#include <ml/nms.hpp>
+
+#include <opencv2/opencv.hpp>
+
+#include <chrono>
+#include <numeric>
+#include <random>
+
+using namespace ivd::test;
+
+namespace {
+    // Dense, heavily overlapping candidates clustered around a number of objects
+    ivd::ml::BoxCandidates createCandidates(size_t count, size_t objects, int classes, uint32_t seed = 42) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(0, 1200);
+        std::uniform_real_distribution<float> size(20, 200);
+        std::normal_distribution<float> jitter(0, 8);
+        std::uniform_real_distribution<float> score(0.01, 1);
+        std::uniform_int_distribution<int> classId(0, classes - 1);
+
+        std::vector<cv::Rect2f> centers;
+        for (size_t i = 0; i < objects; i++) {
+            centers.emplace_back(position(rng), position(rng) / 3, size(rng), size(rng));
+        }
+
+        ivd::ml::BoxCandidates candidates;
+        candidates.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            auto &center = centers[i % objects];
+            float x1 = center.x + jitter(rng);
+            float y1 = center.y + jitter(rng);
+            float x2 = x1 + std::max(1.f, center.width + jitter(rng));
+            float y2 = y1 + std::max(1.f, center.height + jitter(rng));
+            candidates.push_back(x1, y1, x2, y2, score(rng), classId(rng));
+        }
+        return candidates;
+    }
+
+    std::vector<cv::Rect2d> toRects(const ivd::ml::BoxCandidates &candidates, const std::vector<int> &indices) {
+        std::vector<cv::Rect2d> rects;
+        for (auto i: indices) {
+            rects.emplace_back(candidates.x1[i], candidates.y1[i], candidates.x2[i] - candidates.x1[i],
+                               candidates.y2[i] - candidates.y1[i]);
+        }
+        return rects;
+    }
+
+    std::vector<int> referenceNMS(const ivd::ml::BoxCandidates &candidates, const ivd::ml::NMSOptions &options) {
+        std::vector<int> all(candidates.size());
+        std::iota(all.begin(), all.end(), 0);
+        std::vector<int> result;
+        cv::dnn::NMSBoxes(toRects(candidates, all), candidates.scores, options.scoreThreshold, options.iouThreshold,
+                          result);
+        return result;
+    }
+
+    template<class Fn>
+    double timeMs(Fn &&fn, int iterations = 10) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            fn();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    }
+}
+
+TEST(NMS, Empty) {
+    ivd::ml::BoxCandidates candidates;
+    ASSERT_TRUE(ivd::ml::nms(candidates, {}).empty());
+}
+
+TEST(NMS, SuppressOverlapping) {
+    ivd::ml::BoxCandidates candidates;
+    candidates.push_back(0, 0, 10, 10, 0.9, 0);
+    candidates.push_back(1, 1, 11, 11, 0.8, 0); // Overlaps first
+    candidates.push_back(20, 20, 30, 30, 0.7, 0);
+    candidates.push_back(1, 1, 11, 11, 0.95, 1); // Overlaps first, other class
+    candidates.push_back(40, 40, 50, 50, 0.1, 0); // Below score threshold
+
+    auto agnostic = ivd::ml::nms(candidates, {0.25, 0.45, 0, true});
+    ASSERT_EQ(agnostic, (std::vector<int>{3, 2}));
+
+    auto perClass = ivd::ml::nms(candidates, {0.25, 0.45, 0, false});
+    ASSERT_EQ(perClass, (std::vector<int>{3, 0, 2}));
+}
+
+TEST(NMS, TopK) {
+    ivd::ml::BoxCandidates candidates;
+    for (int i = 0; i < 10; i++) {
+        candidates.push_back(i * 20.f, 0, i * 20.f + 10, 10, 0.3f + i * 0.05f, 0);
+    }
+    auto result = ivd::ml::nms(candidates, {0.25, 0.45, 3, true});
+    ASSERT_EQ(result, (std::vector<int>{9, 8, 7}));
+}
+
+TEST(NMS, MatchesOpenCVClassAgnostic) {
+    auto candidates = createCandidates(2000, 100, 80);
+    ivd::ml::NMSOptions options{0.25, 0.45, 0, true};
+    ASSERT_EQ(ivd::ml::nms(candidates, options), referenceNMS(candidates, options));
+}
+
+TEST(NMS, MatchesOpenCVPerClass) {
+    auto candidates = createCandidates(2000, 100, 10);
+    ivd::ml::NMSOptions options{0.25, 0.45, 0, false};
+
+    std::vector<int> expected;
+    for (int c = 0; c < 10; c++) {
+        std::vector<int> classIndices;
+        for (int i = 0; i < int(candidates.size()); i++) {
+            if (candidates.classIds[i] == c) {
+                classIndices.push_back(i);
+            }
+        }
+        std::vector<float> classScores;
+        for (auto i: classIndices) {
+            classScores.push_back(candidates.scores[i]);
+        }
+        std::vector<int> classResult;
+        cv::dnn::NMSBoxes(toRects(candidates, classIndices), classScores, options.scoreThreshold,
+                          options.iouThreshold, classResult);
+        for (auto i: classResult) {
+            expected.push_back(classIndices[i]);
+        }
+    }
+
+    auto result = ivd::ml::nms(candidates, options);
+    std::sort(expected.begin(), expected.end());
+    std::sort(result.begin(), result.end());
+    ASSERT_EQ(result, expected);
+}
+
+TEST(NMS, Benchmark) {
+    for (size_t count: {1000, 5000, 20000}) {
+        auto candidates = createCandidates(count, 300, 80);
+        std::vector<int> all(candidates.size());
+        std::iota(all.begin(), all.end(), 0);
+        auto rects = toRects(candidates, all);
+        auto intRects = std::vector<cv::Rect>(rects.begin(), rects.end());
+
+        auto opencvMs = timeMs([&]() {
+            std::vector<int> result;
+            cv::dnn::NMSBoxes(intRects, candidates.scores, 0.25, 0.45, result);
+        });
+        auto agnosticMs = timeMs([&]() { ivd::ml::nms(candidates, {0.25, 0.45, 0, true}); });
+        auto perClassMs = timeMs([&]() { ivd::ml::nms(candidates, {0.25, 0.45, 0, false}); });
+        auto topKMs = timeMs([&]() { ivd::ml::nms(candidates, {0.25, 0.45, 1000, false}); });
+
+        std::cout << "NMS " << count << " candidates: cv::dnn::NMSBoxes " << opencvMs << "ms, class agnostic "
+                  << agnosticMs << "ms, per class " << perClassMs << "ms, per class top 1000 " << topKMs << "ms"
+                  << std::endl;
+    }
+}
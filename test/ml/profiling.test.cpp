@@ -0,0 +1,72 @@
+#include <test.hpp>
+
+#include <ml/detect_ml_model.hpp>
+#include <ml/profiling.hpp>
+
+using namespace ivd::test;
+
+TEST(Profiling, Percentiles) {
+    ivd::ml::LatencyHistogram histogram;
+    for (int i = 1; i <= 100; i++) {
+        histogram.record(i);
+    }
+    ASSERT_EQ(histogram.count(), 100);
+    ASSERT_DOUBLE_EQ(histogram.percentile(50), 50);
+    ASSERT_DOUBLE_EQ(histogram.percentile(95), 95);
+    ASSERT_DOUBLE_EQ(histogram.percentile(99), 99);
+    ASSERT_DOUBLE_EQ(histogram.mean(), 50.5);
+    ASSERT_DOUBLE_EQ(histogram.max(), 100);
+}
+
+TEST(Profiling, PercentilesOverLastSamples) {
+    ivd::ml::LatencyHistogram histogram(10);
+    for (int i = 0; i < 100; i++) {
+        histogram.record(i < 90 ? 1000 : 1);
+    }
+    ASSERT_EQ(histogram.count(), 100);
+    ASSERT_DOUBLE_EQ(histogram.percentile(99), 1);
+
+    histogram.reset();
+    ASSERT_EQ(histogram.count(), 0);
+    ASSERT_DOUBLE_EQ(histogram.percentile(50), 0);
+}
+
+TEST(Profiling, DetectMLModel) {
+    ivd::ml::DetectMLModel model{getModelsPath() / "yolo" / "yolov8n-seg.onnx"};
+    cv::Mat image = cv::imread(getFixturesPath() / "ml" / "yolov8-seg" / "image00" / "image.png");
+
+    for (int i = 0; i < 3; i++) {
+        model.predict(image);
+    }
+
+    auto &profiler = model.profiler();
+    std::cout << profiler.report();
+
+    using Stage = ivd::ml::Profiler::Stage;
+    using Counter = ivd::ml::Profiler::Counter;
+    if constexpr (ivd::ml::Profiler::enabled()) {
+        for (auto stage: {Stage::Preprocess, Stage::Inference, Stage::Decode, Stage::NMS, Stage::Mask, Stage::Total}) {
+            ASSERT_EQ(profiler.histogram(stage).count(), 3) << ivd::ml::Profiler::name(stage);
+        }
+        ASSERT_EQ(profiler.total(Counter::Frames), 3);
+        ASSERT_GE(profiler.total(Counter::Candidates), profiler.total(Counter::Detections));
+        ASSERT_GT(profiler.total(Counter::Detections), 0);
+        ASSERT_LE(profiler.summary(Stage::Inference).p50, profiler.summary(Stage::Total).max);
+    } else {
+        ASSERT_EQ(profiler.histogram(Stage::Total).count(), 0);
+        ASSERT_EQ(profiler.total(Counter::Frames), 0);
+    }
+
+    model.resetProfiler();
+    ASSERT_EQ(model.profiler().histogram(Stage::Total).count(), 0);
+}
+
+TEST(Profiling, OrtProfiler) {
+    auto prefix = std::filesystem::temp_directory_path() / "hello_kitti_ort_profile";
+    ivd::ml::DetectMLModel model{getModelsPath() / "yolo" / "yolov8n.onnx", {false, prefix}};
+    model.predict(cv::imread(getFixturesPath() / "ml" / "yolov8" / "image00" / "image.png"));
+
+    auto trace = model.endProfiling();
+    ASSERT_TRUE(exists(trace));
+    std::filesystem::remove(trace);
+}
@@ -0,0 +1,111 @@
+#include <test.hpp>
+
+#include <kitti/kitti_utils.hpp>
+#include <lidar/lidar.hpp>
+#include <ml/stereo_ml_model.hpp>
+#include <stereo/depth_map.hpp>
+#include <stereo/disparity.hpp>
+
+#include <opencv2/opencv.hpp>
+
+using namespace ivd;
+using namespace ivd::test;
+
+namespace {
+    std::filesystem::path stereoModelPath() {
+        return getModelsPath() / "stereo" / "stereo.onnx";
+    }
+
+    struct Accuracy {
+        // Mean absolute error (px) and fraction of pixels off by more than 3px, at the lidar points
+        double meanError{0};
+        double outliers{0};
+        size_t count{0};
+    };
+
+    /**
+     * Disparity error against the lidar fixture (same frame as the stereo fixture), the lidar depths converted
+     * with d = f * b / z. Pixels without a valid disparity count as outliers.
+     */
+    Accuracy lidarAccuracy(const cv::Mat &disparity) {
+        auto T = getVeloCam2Projection();
+        auto calibration = getStereoCalibration();
+        stereo::DepthMapCalculator calculator(calibration.K_left, calibration.T_left, calibration.T_right);
+        const double fb = calculator.focalLength() * calculator.baseline();
+        auto points = lidar::projectVelodyne(
+                kitti::readVeloBin(getFixturesPath() / "lidar" / "00_basic" / "lidar_points_raw.bin"), T,
+                disparity.size());
+
+        Accuracy accuracy;
+        double errors = 0;
+        size_t outliers = 0;
+        for (size_t i = 0; i < points.size(); i++) {
+            auto expected = fb / points.z[i];
+            auto d = disparity.at<float>(int(points.v[i]), int(points.u[i]));
+            auto error = d > 0 ? std::abs(d - expected) : expected;
+            errors += error;
+            outliers += error > 3;
+            accuracy.count++;
+        }
+        accuracy.meanError = errors / double(std::max<size_t>(accuracy.count, 1));
+        accuracy.outliers = double(outliers) / double(std::max<size_t>(accuracy.count, 1));
+        return accuracy;
+    }
+}
+
+TEST(StereoMLModel, Predict) {
+    if (!exists(stereoModelPath())) {
+        GTEST_SKIP() << "Stereo model not exported (target stereo_export_model): " << stereoModelPath();
+    }
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto left = cv::imread(baseDir / "left.png");
+    auto right = cv::imread(baseDir / "right.png");
+
+    ml::StereoMLModel model(stereoModelPath());
+    auto size = model.inputSize(left.size());
+    ASSERT_GT(size.width, 0);
+    ASSERT_GT(size.height, 0);
+
+    // Same contract as SGBM
+    auto disparity = model.predict(left, right);
+    ASSERT_EQ(disparity.type(), CV_32F);
+    ASSERT_EQ(disparity.size(), left.size());
+
+    // Gray input works as well
+    cv::Mat leftGray, rightGray;
+    cv::cvtColor(left, leftGray, cv::COLOR_BGR2GRAY);
+    cv::cvtColor(right, rightGray, cv::COLOR_BGR2GRAY);
+    auto grayDisparity = model.predict(leftGray, rightGray);
+    ASSERT_EQ(grayDisparity.size(), left.size());
+
+    auto accuracy = lidarAccuracy(disparity);
+    ASSERT_GT(accuracy.count, 0);
+    ASSERT_LT(accuracy.outliers, 0.5);
+}
+
+TEST(StereoMLModel, CompareSGBM) {
+    if (!exists(stereoModelPath())) {
+        GTEST_SKIP() << "Stereo model not exported (target stereo_export_model): " << stereoModelPath();
+    }
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto left = cv::imread(baseDir / "left.png");
+    auto right = cv::imread(baseDir / "right.png");
+    cv::Mat leftGray, rightGray;
+    cv::cvtColor(left, leftGray, cv::COLOR_BGR2GRAY);
+    cv::cvtColor(right, rightGray, cv::COLOR_BGR2GRAY);
+    const int iterations = 5;
+
+    stereo::DisparityEstimator sgbm;
+    ml::StereoMLModel model(stereoModelPath());
+    cv::Mat sgbmDisparity, mlDisparity;
+    auto sgbmMs = timeMs([&]() { sgbm.compute(leftGray, rightGray, sgbmDisparity); }, iterations);
+    auto mlMs = timeMs([&]() { model.predict(left, right, mlDisparity); }, iterations);
+
+    auto sgbmAccuracy = lidarAccuracy(sgbmDisparity);
+    auto mlAccuracy = lidarAccuracy(mlDisparity);
+    std::cout << "Stereo " << left.size() << " (model at " << model.inputSize(left.size()) << "), "
+              << sgbmAccuracy.count << " lidar points:\n\tSGBM " << sgbmMs << "ms, error "
+              << sgbmAccuracy.meanError << "px, " << sgbmAccuracy.outliers * 100 << "% > 3px\n\tONNX " << mlMs
+              << "ms, error " << mlAccuracy.meanError << "px, " << mlAccuracy.outliers * 100 << "% > 3px"
+              << std::endl;
+}
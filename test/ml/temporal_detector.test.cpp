@@ -0,0 +1,76 @@
+#include <test.hpp>
+
+#include <ml/temporal_detector.hpp>
+
+using namespace ivd::test;
+
+namespace {
+    cv::Mat loadImage(const std::string &name) {
+        return cv::imread(getFixturesPath() / "ml" / "yolov8" / name / "image.png");
+    }
+
+    cv::Mat translate(const cv::Mat &image, double dx, double dy) {
+        cv::Mat result;
+        cv::Mat translation = (cv::Mat_<double>(2, 3) << 1, 0, dx, 0, 1, dy);
+        cv::warpAffine(image, result, translation, image.size(), cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+        return result;
+    }
+}
+
+TEST(TemporalDetector, SkipStaticFrames) {
+    ivd::ml::DetectMLModel model{getModelsPath() / "yolo" / "yolov8n.onnx"};
+    ivd::ml::TemporalDetector detector{model, {4.0, 2}};
+    auto image = loadImage("image00");
+
+    auto first = detector.predict(image);
+    ASSERT_TRUE(detector.lastFrameInferred());
+    ASSERT_FALSE(first.empty());
+
+    for (int i = 0; i < 2; i++) {
+        auto reused = detector.predict(image);
+        ASSERT_FALSE(detector.lastFrameInferred());
+        ASSERT_EQ(reused.size(), first.size());
+        for (size_t d = 0; d < first.size(); d++) {
+            ASSERT_EQ(reused[d].bbox, first[d].bbox);
+        }
+    }
+
+    // Max skipped frames reached
+    detector.predict(image);
+    ASSERT_TRUE(detector.lastFrameInferred());
+
+    ASSERT_EQ(detector.stats().frames, 4);
+    ASSERT_EQ(detector.stats().inferred, 2);
+    ASSERT_EQ(detector.stats().skipped, 2);
+}
+
+TEST(TemporalDetector, InferChangedFrames) {
+    ivd::ml::DetectMLModel model{getModelsPath() / "yolo" / "yolov8n.onnx"};
+    ivd::ml::TemporalDetector detector{model};
+
+    for (auto name: {"image00", "image01", "image02"}) {
+        detector.predict(loadImage(name));
+        ASSERT_TRUE(detector.lastFrameInferred());
+    }
+    ASSERT_EQ(detector.stats().skipped, 0);
+}
+
+TEST(TemporalDetector, PropagateShift) {
+    ivd::ml::DetectMLModel model{getModelsPath() / "yolo" / "yolov8n.onnx"};
+    ivd::ml::TemporalDetector::Options options;
+    options.measureDrift = true;
+    ivd::ml::TemporalDetector detector{model, options};
+    auto image = loadImage("image00");
+
+    auto first = detector.predict(image);
+    auto shifted = detector.predict(translate(image, 8, 0));
+    ASSERT_FALSE(detector.lastFrameInferred());
+    ASSERT_FALSE(shifted.empty());
+
+    // Boxes follow the image content
+    auto &stats = detector.stats();
+    std::cout << "Drift IoU: " << stats.meanDriftIoU() << ", missed: " << stats.missed << ", spurious: "
+              << stats.spurious << std::endl;
+    ASSERT_EQ(stats.driftSamples, model.predict(translate(image, 8, 0)).size());
+    ASSERT_GT(stats.meanDriftIoU(), 0.7);
+}
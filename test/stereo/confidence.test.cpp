@@ -0,0 +1,71 @@
+#include <test.hpp>
+
+#include <stereo/confidence.hpp>
+#include <stereo/disparity.hpp>
+
+#include <opencv2/opencv.hpp>
+
+using namespace ivd::test;
+
+TEST(Confidence, LeftRightConsistency) {
+    cv::Mat left(10, 40, CV_32F, cv::Scalar(10));
+    cv::Mat right(10, 40, CV_32F, cv::Scalar(10));
+    left.at<float>(0, 5) = -1;
+    right.at<float>(1, 20) = 11;
+    right.at<float>(2, 20) = 20;
+
+    auto confidence = ivd::stereo::leftRightConfidence(left, right, 2);
+    ASSERT_EQ(confidence.type(), CV_32F);
+    ASSERT_EQ(confidence.size(), left.size());
+
+    // Consistent
+    ASSERT_EQ(confidence.at<float>(0, 30), 1);
+    // Invalid or matching outside of the right image
+    ASSERT_EQ(confidence.at<float>(0, 5), 0);
+    ASSERT_EQ(confidence.at<float>(3, 9), 0);
+    // Off by a pixel, off by far
+    ASSERT_FLOAT_EQ(confidence.at<float>(1, 30), 0.5);
+    ASSERT_EQ(confidence.at<float>(2, 30), 0);
+}
+
+TEST(Confidence, Fixture) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto left = cv::imread(baseDir / "left.png", cv::IMREAD_GRAYSCALE);
+    auto right = cv::imread(baseDir / "right.png", cv::IMREAD_GRAYSCALE);
+
+    ivd::stereo::DisparityEstimator estimator;
+    auto leftDisparity = estimator.compute(left, right);
+    cv::Mat rightDisparity;
+    estimator.computeRight(left, right, rightDisparity);
+    ASSERT_EQ(rightDisparity.type(), CV_32F);
+    ASSERT_EQ(rightDisparity.size(), right.size());
+
+    // Most valid disparities are consistent
+    auto confidence = ivd::stereo::leftRightConfidence(leftDisparity, rightDisparity);
+    auto valid = cv::countNonZero(leftDisparity > 0);
+    auto consistent = cv::countNonZero(confidence > 0.5);
+    std::cout << consistent << " of " << valid << " valid disparities consistent" << std::endl;
+    ASSERT_GT(consistent, valid / 2);
+}
+
+TEST(Confidence, Uniqueness) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto left = cv::imread(baseDir / "left.png", cv::IMREAD_GRAYSCALE);
+    auto right = cv::imread(baseDir / "right.png", cv::IMREAD_GRAYSCALE);
+
+    ivd::stereo::SGBMParameters parameters;
+    parameters.uniquenessRatio = 10;
+    ivd::stereo::DisparityEstimator unique(parameters);
+    auto leftDisparity = unique.compute(left, right);
+    cv::Mat rightDisparity;
+    unique.computeRight(left, right, rightDisparity);
+
+    // Ambiguous matches are dropped, and get no confidence
+    auto valid = cv::countNonZero(leftDisparity > 0);
+    auto allValid = cv::countNonZero(ivd::stereo::DisparityEstimator().compute(left, right) > 0);
+    std::cout << valid << " of " << allValid << " disparities unique" << std::endl;
+    ASSERT_LT(valid, allValid);
+
+    auto confidence = ivd::stereo::leftRightConfidence(leftDisparity, rightDisparity);
+    ASSERT_EQ(cv::countNonZero((confidence > 0) & (leftDisparity <= 0)), 0);
+}
@@ -1,10 +1,13 @@
 #include <test.hpp>
 #include <stereo_test_utils.hpp>
 
+#include <common/depth_format.hpp>
 #include <stereo/depth_map.hpp>
 
 #include <opencv2/opencv.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 
 using namespace ivd::test;
@@ -45,4 +48,184 @@ TEST(DepthMap, CalculateDepthMap) {
                                  depthMap.size().height, diff.data, threshold);
     cv::imwrite(baseDir / "depthMap_diff.png", diff);
     EXPECT_LT(mismatched, depthMap.total() * threshold);
-}
\ No newline at end of file
+}
+
+TEST(DepthMap, DepthMapCalculator) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto disparity = readDisparityBin(baseDir / "disparity.bin").clone();
+    auto K_left = readMat(baseDir / "K_left.txt");
+    auto T_left = readMat(baseDir / "T_left.txt");
+    auto T_right = readMat(baseDir / "T_right.txt");
+
+    auto original = disparity.clone();
+    ivd::stereo::DepthMapCalculator calculator(K_left, T_left, T_right);
+    auto depth = calculator.compute(disparity);
+    ASSERT_EQ(depth.type(), CV_32F);
+    ASSERT_EQ(depth.size(), disparity.size());
+
+    // Input untouched
+    ASSERT_EQ(cv::norm(disparity, original, cv::NORM_INF), 0);
+
+    auto copy = disparity.clone();
+    auto expected = ivd::stereo::calculateDepthMap(copy, K_left, T_left, T_right);
+    for (int row = 0; row < depth.rows; row++) {
+        for (int col = 0; col < depth.cols; col++) {
+            auto d = disparity.at<float>(row, col);
+            if (d > 0) {
+                ASSERT_NEAR(depth.at<float>(row, col), expected.at<float>(row, col),
+                            expected.at<float>(row, col) * 1e-5);
+            } else {
+                ASSERT_EQ(depth.at<float>(row, col), 0);
+            }
+        }
+    }
+
+    // Fixed point input gives the same
+    cv::Mat raw;
+    disparity.convertTo(raw, CV_16S, 16);
+    ASSERT_EQ(cv::norm(calculator.compute(raw), depth, cv::NORM_INF), 0);
+
+    // Output reused
+    auto *data = depth.data;
+    calculator.compute(disparity, depth);
+    ASSERT_EQ(depth.data, data);
+}
+
+TEST(DepthMap, DepthMapCalculator_Benchmark) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto disparity = readDisparityBin(baseDir / "disparity.bin").clone();
+    auto K_left = readMat(baseDir / "K_left.txt");
+    auto T_left = readMat(baseDir / "T_left.txt");
+    auto T_right = readMat(baseDir / "T_right.txt");
+    const int iterations = 50;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        auto copy = disparity.clone();
+        ivd::stereo::calculateDepthMap(copy, K_left, T_left, T_right);
+    }
+    auto calculateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ivd::stereo::DepthMapCalculator calculator(K_left, T_left, T_right);
+    cv::Mat depth;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        calculator.compute(disparity, depth);
+    }
+    auto lutMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Depth map " << disparity.size() << ": calculateDepthMap " << calculateMs / iterations
+              << "ms (incl. copy of the input it modifies), DepthMapCalculator " << lutMs / iterations << "ms"
+              << std::endl;
+}
+
+TEST(DepthMap, RobustDepth) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto disparity = readDisparityBin(baseDir / "disparity.bin").clone();
+    auto K_left = readMat(baseDir / "K_left.txt");
+    auto T_left = readMat(baseDir / "T_left.txt");
+    auto T_right = readMat(baseDir / "T_right.txt");
+    auto copy = disparity.clone();
+    auto depthMap = ivd::stereo::calculateDepthMap(copy, K_left, T_left, T_right);
+    cv::Rect box{700, 160, 200, 100};
+
+    auto median = [&](const cv::Mat &mask) {
+        std::vector<float> values;
+        for (int row = 0; row < box.height; row++) {
+            for (int col = 0; col < box.width; col++) {
+                auto z = depthMap.at<float>(box.y + row, box.x + col);
+                if (z > 0 && z < 120 && (mask.empty() || mask.at<uchar>(row, col))) {
+                    values.push_back(z);
+                }
+            }
+        }
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    };
+
+    // Placeholder depths of invalid disparities are ignored
+    auto depth = ivd::stereo::getDepth(depthMap, box, cv::Mat());
+    ASSERT_TRUE(depth.has_value());
+    ASSERT_NEAR(*depth, median({}), 0.1);
+
+    // Same on the depth of DepthMapCalculator (0 == invalid)
+    ivd::stereo::DepthMapCalculator calculator(K_left, T_left, T_right);
+    ASSERT_NEAR(*ivd::stereo::getDepth(calculator.compute(disparity), box, cv::Mat()), *depth, 0.1);
+
+    // Masked
+    cv::Mat mask(box.size(), CV_8U, cv::Scalar(0));
+    mask(cv::Rect(0, 0, box.width / 2, box.height)).setTo(255);
+    auto masked = ivd::stereo::getDepth(depthMap, box, mask);
+    ASSERT_NEAR(*masked, median(mask), 0.1);
+
+    // Zero confidence is the same as masked out
+    cv::Mat confidence(depthMap.size(), CV_32F, cv::Scalar(0));
+    confidence(box)(cv::Rect(0, 0, box.width / 2, box.height)).setTo(1);
+    ASSERT_NEAR(*ivd::stereo::getDepth(depthMap, box, cv::Mat(), confidence), *masked, 1e-6);
+
+    // Nothing valid
+    ASSERT_FALSE(ivd::stereo::getDepth(depthMap, box, cv::Mat(box.size(), CV_8U, cv::Scalar(0))).has_value());
+}
+
+TEST(DepthMap, RobustDepth_Compact) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto disparity = readDisparityBin(baseDir / "disparity.bin").clone();
+    ivd::stereo::DepthMapCalculator calculator(readMat(baseDir / "K_left.txt"), readMat(baseDir / "T_left.txt"),
+                                               readMat(baseDir / "T_right.txt"));
+    auto depthMap = calculator.compute(disparity);
+    cv::Rect box{700, 160, 200, 100};
+
+    auto expected = ivd::stereo::getDepth(depthMap, box, cv::Mat());
+    ASSERT_TRUE(expected.has_value());
+
+    // Histogram bins (5cm) dominate the error of the formats
+    for (auto type: {CV_16U, CV_16F}) {
+        auto depth = ivd::stereo::getDepth(ivd::common::convertDepth(depthMap, type), box, cv::Mat());
+        ASSERT_TRUE(depth.has_value());
+        ASSERT_NEAR(*depth, *expected, 0.1) << type;
+    }
+    ASSERT_NEAR(ivd::stereo::getDepth(ivd::common::convertDepth(depthMap, CV_16U), box),
+                ivd::stereo::getDepth(depthMap, box), 0.5 / ivd::common::depthScale16U);
+}
+
+TEST(DepthMap, GetDepths) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto disparity = readDisparityBin(baseDir / "disparity.bin").clone();
+    ivd::stereo::DepthMapCalculator calculator(readMat(baseDir / "K_left.txt"), readMat(baseDir / "T_left.txt"),
+                                               readMat(baseDir / "T_right.txt"));
+    auto depthMap = calculator.compute(disparity);
+
+    std::vector<cv::Rect> boxes;
+    std::vector<cv::Mat> masks;
+    for (int y = 0; y + 100 <= depthMap.rows; y += 50) {
+        for (int x = 0; x + 160 <= depthMap.cols; x += 120) {
+            boxes.emplace_back(x, y, 160, 100);
+            masks.emplace_back(boxes.size() % 2 ? cv::Mat() : cv::Mat(100, 160, CV_8U, cv::Scalar(255)));
+        }
+    }
+    cv::Mat confidence(depthMap.size(), CV_32F, cv::Scalar(1));
+    confidence.colRange(0, depthMap.cols / 2).setTo(0.25);
+
+    // Same as one by one, in order
+    auto depths = ivd::stereo::getDepths(depthMap, boxes, masks, confidence);
+    ASSERT_EQ(depths.size(), boxes.size());
+    for (size_t i = 0; i < boxes.size(); i++) {
+        ASSERT_EQ(depths[i], ivd::stereo::getDepth(depthMap, boxes[i], masks[i], confidence)) << boxes[i];
+    }
+
+    const int iterations = 20;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (size_t b = 0; b < boxes.size(); b++) {
+            ivd::stereo::getDepth(depthMap, boxes[b], masks[b], confidence);
+        }
+    }
+    auto serialMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        ivd::stereo::getDepths(depthMap, boxes, masks, confidence);
+    }
+    auto batchedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << boxes.size() << " box queries: serial " << serialMs / iterations << "ms, batched "
+              << batchedMs / iterations << "ms" << std::endl;
+}
@@ -3,6 +3,8 @@
 #include <stereo/disparity.hpp>
 #include <opencv2/opencv.hpp>
 
+#include <chrono>
+
 using namespace ivd::test;
 
 TEST(Disparity, SGBM_SmokeTest) {
@@ -27,4 +29,57 @@ TEST(Disparity, SGBM_SmokeTest) {
                                  disparity.size().height, diff.data, threshold);
     cv::imwrite(baseDir / "disparity_diff.png", diff);
     EXPECT_LT(mismatched, disparity.total() * threshold);
-}
\ No newline at end of file
+}
+
+TEST(Disparity, Estimator) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto left = cv::imread(baseDir / "left.png", cv::IMREAD_GRAYSCALE);
+    auto right = cv::imread(baseDir / "right.png", cv::IMREAD_GRAYSCALE);
+
+    ivd::stereo::DisparityEstimator estimator;
+    auto disparity = estimator.compute(left, right);
+    ASSERT_EQ(disparity.size(), left.size());
+    ASSERT_EQ(disparity.type(), CV_32F);
+    ASSERT_EQ(estimator.raw().type(), CV_16S);
+
+    // Same as the per frame function
+    ASSERT_EQ(cv::norm(disparity, ivd::stereo::disparityMapSGBM(left, right), cv::NORM_INF), 0);
+
+    // Reuses the output
+    auto *data = disparity.data;
+    estimator.compute(left, right, disparity);
+    ASSERT_EQ(disparity.data, data);
+
+    // Parameters are applied
+    ivd::stereo::SGBMParameters parameters;
+    parameters.numDisparities = 64;
+    estimator.setParameters(parameters);
+    estimator.compute(left, right, disparity);
+    double maxDisparity;
+    cv::minMaxLoc(disparity, nullptr, &maxDisparity);
+    ASSERT_LT(maxDisparity, 64);
+}
+
+TEST(Disparity, Estimator_Benchmark) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto left = cv::imread(baseDir / "left.png", cv::IMREAD_GRAYSCALE);
+    auto right = cv::imread(baseDir / "right.png", cv::IMREAD_GRAYSCALE);
+    const int iterations = 5;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        ivd::stereo::disparityMapSGBM(left, right);
+    }
+    auto perFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ivd::stereo::DisparityEstimator estimator;
+    cv::Mat disparity;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        estimator.compute(left, right, disparity);
+    }
+    auto estimatorMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "SGBM " << left.size() << ": disparityMapSGBM " << perFrameMs / iterations
+              << "ms/frame, DisparityEstimator " << estimatorMs / iterations << "ms/frame" << std::endl;
+}
@@ -0,0 +1,68 @@
+#include <test.hpp>
+#include <stereo_test_utils.hpp>
+
+#include <stereo/disparity.hpp>
+#include <stereo/parallel_disparity.hpp>
+
+#include <opencv2/opencv.hpp>
+
+using namespace ivd::test;
+
+TEST(ParallelDisparity, MatchesSingleStrip) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto left = cv::imread(baseDir / "left.png", cv::IMREAD_GRAYSCALE);
+    auto right = cv::imread(baseDir / "right.png", cv::IMREAD_GRAYSCALE);
+
+    auto expected = ivd::stereo::DisparityEstimator().compute(left, right);
+
+    // A single strip is the same matcher
+    auto single = ivd::stereo::StripDisparityEstimator({}, {1, 24}).compute(left, right);
+    ASSERT_EQ(cv::norm(single, expected, cv::NORM_INF), 0);
+
+    for (int strips: {2, 4, 8}) {
+        ivd::stereo::StripDisparityEstimator estimator({}, {strips, 24});
+        auto disparity = estimator.compute(left, right);
+        ASSERT_EQ(disparity.size(), left.size());
+        ASSERT_EQ(disparity.type(), CV_32F);
+        ASSERT_EQ(estimator.stripCount(left.rows), strips);
+        auto fraction = mismatchedFraction(disparity, expected);
+        std::cout << strips << " strips (" << estimator.stripCount(left.rows) << " used): " << fraction * 100
+                  << "% of the pixels differ by > 1px" << std::endl;
+        ASSERT_LT(fraction, 0.01);
+    }
+}
+
+TEST(ParallelDisparity, StripCount) {
+    // At least two blocks (11 rows) high
+    ASSERT_EQ(ivd::stereo::StripDisparityEstimator({}, {1000, 24}).stripCount(375), 375 / 22);
+    ASSERT_EQ(ivd::stereo::StripDisparityEstimator({}, {32, 24}).stripCount(375), 17);
+    ASSERT_EQ(ivd::stereo::StripDisparityEstimator({}, {4, 24}).stripCount(375), 4);
+    ASSERT_EQ(ivd::stereo::StripDisparityEstimator({}, {4, 24}).stripCount(10), 1);
+
+    // One per thread by default
+    ASSERT_EQ(ivd::stereo::StripDisparityEstimator().stripCount(375), std::min(cv::getNumThreads(), 17));
+}
+
+TEST(ParallelDisparity, ThreadScaling_Benchmark) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto left = cv::imread(baseDir / "left.png", cv::IMREAD_GRAYSCALE);
+    auto right = cv::imread(baseDir / "right.png", cv::IMREAD_GRAYSCALE);
+    const int iterations = 5;
+    const int maxThreads = cv::getNumThreads();
+
+    cv::Mat disparity;
+    auto time = [&](auto &estimator) {
+        return timeMs([&]() { estimator.compute(left, right, disparity); }, iterations);
+    };
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        cv::setNumThreads(threads);
+        ivd::stereo::DisparityEstimator single;
+        ivd::stereo::StripDisparityEstimator strips;
+        auto singleMs = time(single);
+        auto stripsMs = time(strips);
+        std::cout << threads << " threads: SGBM " << singleMs << "ms/frame, strip parallel SGBM " << stripsMs
+                  << "ms/frame (" << strips.stripCount(left.rows) << " strips)" << std::endl;
+    }
+    cv::setNumThreads(maxThreads);
+}
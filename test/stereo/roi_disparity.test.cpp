@@ -0,0 +1,98 @@
+#include <test.hpp>
+#include <stereo_test_utils.hpp>
+
+#include <stereo/disparity.hpp>
+#include <stereo/roi_disparity.hpp>
+
+#include <opencv2/opencv.hpp>
+
+using namespace ivd::test;
+
+namespace {
+    const std::vector<cv::Rect> boxes{{300, 180, 120, 80}, {700, 160, 200, 100}, {1000, 150, 150, 120}};
+}
+
+TEST(RoiDisparity, MatchesFullFrame) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto left = cv::imread(baseDir / "left.png", cv::IMREAD_GRAYSCALE);
+    auto right = cv::imread(baseDir / "right.png", cv::IMREAD_GRAYSCALE);
+    auto expected = ivd::stereo::DisparityEstimator().compute(left, right);
+
+    // Full range
+    ivd::stereo::RoiDisparityEstimator full({}, {0});
+    auto disparity = full.compute(left, right, boxes);
+    ASSERT_EQ(disparity.size(), left.size());
+    ASSERT_EQ(disparity.type(), CV_32F);
+    for (auto &box: boxes) {
+        ASSERT_LT(mismatchedFraction(disparity(box), expected(box)), 0.02) << box;
+    }
+
+    // Outside of the boxes nothing is computed
+    ASSERT_EQ(disparity.at<float>(10, 10), -1);
+
+    // Seeded ranges
+    ivd::stereo::RoiDisparityEstimator seeded;
+    auto regions = seeded.regions(left, right, boxes);
+    ASSERT_EQ(regions.size(), boxes.size());
+    cv::Mat seededDisparity;
+    seeded.compute(left, right, regions, seededDisparity);
+    for (size_t i = 0; i < boxes.size(); i++) {
+        std::cout << boxes[i] << ": disparities " << regions[i].minDisparity << " + " << regions[i].numDisparities
+                  << std::endl;
+        ASSERT_LE(regions[i].numDisparities, 80);
+        ASSERT_EQ(regions[i].numDisparities % 16, 0);
+        ASSERT_LT(mismatchedFraction(seededDisparity(boxes[i]), expected(boxes[i])), 0.05) << boxes[i];
+    }
+
+    // Re-ranged matchers give the same disparities as new ones
+    for (auto &region: regions) {
+        region.minDisparity = 0;
+        region.numDisparities = 80;
+    }
+    seeded.compute(left, right, regions, seededDisparity);
+    ASSERT_EQ(cv::norm(seededDisparity, disparity, cv::NORM_INF), 0);
+}
+
+TEST(RoiDisparity, RangeRegion) {
+    ivd::stereo::SGBMParameters parameters; // 0 + 80
+    cv::Rect rect{10, 20, 30, 40};
+
+    // Widened to 16
+    auto region = ivd::stereo::rangeRegion(rect, 20.5, 29.5, parameters);
+    ASSERT_TRUE(region.has_value());
+    ASSERT_EQ(region->rect, rect);
+    ASSERT_EQ(region->minDisparity, 20);
+    ASSERT_EQ(region->numDisparities, 16);
+
+    // Clamped to the search range, shifted down to stay inside it
+    region = ivd::stereo::rangeRegion(rect, 70, 100, parameters);
+    ASSERT_TRUE(region.has_value());
+    ASSERT_EQ(region->minDisparity, 64);
+    ASSERT_EQ(region->numDisparities, 16);
+
+    region = ivd::stereo::rangeRegion(rect, -10, 200, parameters);
+    ASSERT_TRUE(region.has_value());
+    ASSERT_EQ(region->minDisparity, 0);
+    ASSERT_EQ(region->numDisparities, 80);
+
+    // Outside of the search range
+    ASSERT_FALSE(ivd::stereo::rangeRegion(rect, 90, 100, parameters).has_value());
+}
+
+TEST(RoiDisparity, Benchmark) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto left = cv::imread(baseDir / "left.png", cv::IMREAD_GRAYSCALE);
+    auto right = cv::imread(baseDir / "right.png", cv::IMREAD_GRAYSCALE);
+    const int iterations = 5;
+
+    ivd::stereo::DisparityEstimator frame;
+    ivd::stereo::RoiDisparityEstimator full({}, {0});
+    ivd::stereo::RoiDisparityEstimator seeded;
+    cv::Mat disparity;
+    auto frameMs = timeMs([&]() { frame.compute(left, right, disparity); }, iterations);
+    auto fullMs = timeMs([&]() { full.compute(left, right, boxes); }, iterations);
+    auto seededMs = timeMs([&]() { seeded.compute(left, right, boxes); }, iterations);
+
+    std::cout << boxes.size() << " boxes: full frame " << frameMs << "ms, ROI " << fullMs << "ms, seeded ROI "
+              << seededMs << "ms" << std::endl;
+}
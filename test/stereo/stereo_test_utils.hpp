@@ -14,4 +14,11 @@ namespace ivd::test {
         inf.close();
         return cv::Mat{raw, true};
     }
+
+    // Fraction of the pixels valid in expected that differ by more than a pixel
+    static double mismatchedFraction(const cv::Mat &disparity, const cv::Mat &expected) {
+        cv::Mat valid = expected > 0;
+        cv::Mat mismatched = (cv::abs(disparity - expected) > 1) & valid;
+        return double(cv::countNonZero(mismatched)) / std::max(1, cv::countNonZero(valid));
+    }
 }
\ No newline at end of file
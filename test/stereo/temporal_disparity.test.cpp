@@ -0,0 +1,71 @@
+#include <test.hpp>
+#include <stereo_test_utils.hpp>
+
+#include <stereo/disparity.hpp>
+#include <stereo/temporal_disparity.hpp>
+
+#include <opencv2/opencv.hpp>
+
+using namespace ivd::test;
+
+TEST(TemporalDisparity, WarmStart) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto left = cv::imread(baseDir / "left.png", cv::IMREAD_GRAYSCALE);
+    auto right = cv::imread(baseDir / "right.png", cv::IMREAD_GRAYSCALE);
+    auto expected = ivd::stereo::DisparityEstimator().compute(left, right);
+
+    ivd::stereo::TemporalDisparityEstimator estimator;
+    auto first = estimator.compute(left, right);
+    ASSERT_EQ(cv::norm(first, expected, cv::NORM_INF), 0);
+    ASSERT_EQ(estimator.stats().fullFrames, 1);
+
+    // Same frame again, only the previous ranges are searched
+    auto second = estimator.compute(left, right);
+    ASSERT_EQ(estimator.stats().frames, 2);
+    ASSERT_EQ(estimator.stats().fullFrames, 1);
+    ASSERT_LT(mismatchedFraction(second, expected), 0.05);
+    ASSERT_GT(estimator.stats().rangeReduction(), 0);
+
+    // Reset starts over with the full range
+    estimator.reset();
+    estimator.compute(left, right);
+    ASSERT_EQ(estimator.stats().fullFrames, 2);
+}
+
+TEST(TemporalDisparity, Fallback) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto left = cv::imread(baseDir / "left.png", cv::IMREAD_GRAYSCALE);
+    auto right = cv::imread(baseDir / "right.png", cv::IMREAD_GRAYSCALE);
+
+    // Shifting the right image by 24px shifts all disparities beyond the margin, pushing them to the range edges
+    cv::Mat shifted(right.size(), right.type(), cv::Scalar(0));
+    right.colRange(24, right.cols).copyTo(shifted.colRange(0, right.cols - 24));
+
+    ivd::stereo::SGBMParameters parameters;
+    parameters.numDisparities = 112;
+    auto expected = ivd::stereo::DisparityEstimator(parameters).compute(left, shifted);
+
+    ivd::stereo::TemporalDisparityEstimator estimator(parameters);
+    estimator.compute(left, right);
+    auto disparity = estimator.compute(left, shifted);
+    ASSERT_GT(estimator.stats().fallbackTiles, 0);
+    ASSERT_LT(mismatchedFraction(disparity, expected), 0.1);
+}
+
+TEST(TemporalDisparity, Benchmark) {
+    auto baseDir = getFixturesPath() / "stereo" / "00_basic";
+    auto left = cv::imread(baseDir / "left.png", cv::IMREAD_GRAYSCALE);
+    auto right = cv::imread(baseDir / "right.png", cv::IMREAD_GRAYSCALE);
+
+    ivd::stereo::TemporalDisparityEstimator estimator;
+    cv::Mat disparity;
+    for (int i = 0; i < 10; i++) {
+        estimator.compute(left, right, disparity);
+    }
+
+    auto &stats = estimator.stats();
+    std::cout << stats.frames << " frames (" << stats.fullFrames << " full, " << stats.fallbackTiles << "/"
+              << stats.tiles << " tiles fell back): range reduced by " << stats.rangeReduction() * 100
+              << "%, runtime reduced by " << stats.timeSaved() * 100 << "% (full " << stats.fullMs / stats.fullFrames
+              << "ms, warm " << stats.warmMs / double(stats.frames - stats.fullFrames) << "ms)" << std::endl;
+}